@@ -0,0 +1,111 @@
+/**
+ * Decode Plan Benchmark
+ *
+ * Compares two ways of turning a fetched ATFetchSVRes into field objects:
+ * 1. Generic: SVObject.fromSv() + toJSON(), walking the meta fields in JS
+ * 2. Plan: ATFetchSVRes.objects(), running the per-meta plan compiled by updateSchema()
+ *
+ * One fetch response is captured from the Caitlyn server and decoded repeatedly.
+ * Requires a WASM build that exports ATFetchSVRes.objects().
+ *
+ * Usage: CAITLYN_WS_URL=... CAITLYN_TOKEN=... node bench-decode-plan.js [market] [code] [qualifiedName]
+ */
+
+import dotenv from 'dotenv';
+import CaitlynClientConnection from './src/utils/CaitlynClientConnection.js';
+import SVObject from './src/utils/StructValueWrapper.js';
+
+dotenv.config();
+
+const CAITLYN_WS_URL = process.env.CAITLYN_WS_URL;
+const TOKEN = process.env.CAITLYN_TOKEN;
+const MARKET = process.argv[2] || 'DCE';
+const CODE = process.argv[3] || 'i<00>';
+const QUALIFIED_NAME = process.argv[4] || 'SampleQuote';
+const ITERATIONS = parseInt(process.env.BENCH_ITERATIONS || '20', 10);
+
+const quietLogger = { info() {}, debug() {}, warn: console.warn, error: console.error };
+
+function timeIt(label, records, fn) {
+    fn(); // warm up
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < ITERATIONS; i++) {
+        fn();
+    }
+    const ms = Number(process.hrtime.bigint() - start) / 1e6 / ITERATIONS;
+    console.log(`${label.padEnd(10)} ${ms.toFixed(2).padStart(9)} ms/pass  ${(records / ms * 1000).toFixed(0).padStart(10)} records/s`);
+    return ms;
+}
+
+async function runBenchmark() {
+    const connection = new CaitlynClientConnection({ url: CAITLYN_WS_URL, token: TOKEN, logger: quietLogger });
+    await connection.loadWasmModule();
+    const wasm = connection.wasmModule;
+
+    if (typeof wasm.ATFetchSVRes.prototype.objects !== 'function') {
+        console.log('⚠️  This WASM build has no ATFetchSVRes.objects(); rebuild caitlyn_js first');
+        return;
+    }
+
+    // Keep a copy of the first fetch response payload
+    let captured = null;
+    const handleFetch = connection.handleFetchByCodeResponse.bind(connection);
+    connection.handleFetchByCodeResponse = (pkg) => {
+        if (!captured) {
+            captured = pkg.content().slice();
+        }
+        handleFetch(pkg);
+    };
+
+    await connection.connect();
+    console.log(`📋 Compiled decode plans: ${connection.compressor.planCount()}`);
+
+    await connection.fetchByCode(MARKET, CODE, { qualifiedName: QUALIFIED_NAME, namespace: 0, granularity: 86400 });
+
+    const decode = () => {
+        const res = new wasm.ATFetchSVRes();
+        res.setCompressor(connection.compressor);
+        res.decode(captured);
+        return res;
+    };
+
+    const probe = decode();
+    const records = probe.results().size();
+    probe.delete();
+    console.log(`📦 ${records} records of ${MARKET}/${CODE} (${QUALIFIED_NAME}), ${ITERATIONS} passes`);
+
+    const svObject = new SVObject(wasm);
+    svObject.metaName = QUALIFIED_NAME;
+    svObject.namespace = wasm.NAMESPACE_GLOBAL;
+    svObject.loadDefFromDict(connection.schemaByNamespace);
+
+    const generic = timeIt('generic', records, () => {
+        const res = decode();
+        const results = res.results();
+        const out = new Array(results.size());
+        for (let i = 0; i < out.length; i++) {
+            const sv = results.get(i);
+            svObject.fromSv(sv);
+            out[i] = svObject.toJSON().fields;
+            sv.delete();
+        }
+        results.delete();
+        res.delete();
+        return out;
+    });
+
+    const plan = timeIt('plan', records, () => {
+        const res = decode();
+        const out = res.objects();
+        res.delete();
+        return out;
+    });
+
+    console.log(`🚀 Plan speedup: ${(generic / plan).toFixed(2)}x`);
+    connection.disconnect();
+}
+
+runBenchmark().catch(error => {
+    console.error('❌ Benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,143 @@
+/**
+ * Native Indicator Benchmark
+ *
+ * Runs the SMA, RSI and MACD reference classes of src/examples/IndicatorExamples.js
+ * and the native kernels (docs/cxx/caitlyn_js_indicators.hpp) over the same
+ * synthetic close column, checks that they agree and compares:
+ * 1. JS reference: one update() per tick
+ * 2. Native batch: sma(values, period) etc. over a Float64Array
+ * 3. Native streaming: SMAIndicator etc., one update() per tick
+ *
+ * MACD is checked on all three outputs. The native signal line is an EMA
+ * seeded with the first MACD value; the reference reseeds it while it is
+ * exactly 0, i.e. again on the second tick. The two signals differ by a term
+ * that decays by (1 - 2 / (signal + 1)) per tick, so signal and histogram are
+ * compared from MACD_SETTLED on.
+ *
+ * Usage: node bench-indicators.js [rows]
+ */
+
+import WasmService from './src/services/WasmService.js';
+import { SMA, RSI, MACD } from './src/examples/IndicatorExamples.js';
+
+const ROWS = parseInt(process.argv[2] || '100000', 10);
+const ITERATIONS = parseInt(process.env.BENCH_ITERATIONS || '10', 10);
+const TOLERANCE = 1e-9;
+const MACD_SETTLED = 200; // 0.8^200 ~ 4e-20, far below TOLERANCE for any MACD seen here
+
+function timeIt(fn) {
+    fn(); // warm up
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < ITERATIONS; i++) {
+        fn();
+    }
+    return Number(process.hrtime.bigint() - start) / 1e6 / ITERATIONS;
+}
+
+// largest difference over the indices both sides have a value for
+function maxDiff(a, b, from) {
+    let diff = 0;
+    for (let i = from; i < a.length; i++) {
+        if (!Number.isNaN(a[i]) && !Number.isNaN(b[i])) {
+            diff = Math.max(diff, Math.abs(a[i] - b[i]));
+        }
+    }
+    return diff;
+}
+
+function reference(wasm, Indicator, args, closes, read) {
+    const out = new Float64Array(closes.length);
+    const indicator = new Indicator(wasm, ...args);
+    for (let i = 0; i < closes.length; i++) {
+        indicator.update(closes[i]);
+        out[i] = read(indicator);
+    }
+    return out;
+}
+
+// read picks another output than update()'s return value, e.g. (x) => x.signal()
+function streaming(wasm, Indicator, args, closes, read = null) {
+    const out = new Float64Array(closes.length);
+    const indicator = new wasm[Indicator](...args);
+    for (let i = 0; i < closes.length; i++) {
+        const value = indicator.update(closes[i]);
+        out[i] = read ? read(indicator) : value;
+    }
+    indicator.delete();
+    return out;
+}
+
+async function runBenchmark() {
+    const service = new WasmService();
+    await service.initialize();
+    const wasm = service.getModule();
+    if (typeof wasm.sma !== 'function') {
+        console.log('⚠️  This WASM build has no indicator kernels; rebuild caitlyn_js first');
+        return;
+    }
+
+    const closes = new Float64Array(ROWS);
+    let price = 1000;
+    for (let i = 0; i < ROWS; i++) {
+        price = Math.max(1, price + (Math.random() - 0.5) * 4);
+        closes[i] = price;
+    }
+    console.log(`📦 ${ROWS} closes, ${ITERATIONS} passes`);
+
+    const cases = [
+        { name: 'SMA(20)', Ref: SMA, args: [20], read: (x) => x.value, from: 19,
+          batch: () => wasm.sma(closes, 20), native: 'SMAIndicator' },
+        { name: 'RSI(14)', Ref: RSI, args: [14], read: (x) => x.rsi, from: 1,
+          batch: () => wasm.rsi(closes, 14), native: 'RSIIndicator' },
+        { name: 'MACD', Ref: MACD, args: [], read: (x) => x.macd, from: 0,
+          batch: () => wasm.macd(closes, 12, 26, 9).macd, native: 'MACDIndicator', nativeArgs: [12, 26, 9] },
+        { name: 'Signal', Ref: MACD, args: [], read: (x) => x.signal, from: MACD_SETTLED,
+          batch: () => wasm.macd(closes, 12, 26, 9).signal, native: 'MACDIndicator', nativeArgs: [12, 26, 9],
+          nativeRead: (x) => x.signal() },
+        { name: 'Hist', Ref: MACD, args: [], read: (x) => x.histogram, from: MACD_SETTLED,
+          batch: () => wasm.macd(closes, 12, 26, 9).histogram, native: 'MACDIndicator', nativeArgs: [12, 26, 9],
+          nativeRead: (x) => x.histogram() }
+    ];
+
+    let failures = 0;
+    for (const c of cases) {
+        const nativeArgs = c.nativeArgs || c.args;
+        const expected = reference(wasm, c.Ref, c.args, closes, c.read);
+        const diff = Math.max(maxDiff(expected, c.batch(), c.from),
+            maxDiff(expected, streaming(wasm, c.native, nativeArgs, closes, c.nativeRead), c.from));
+        if (diff > TOLERANCE) failures++;
+
+        const js = timeIt(() => reference(wasm, c.Ref, c.args, closes, c.read));
+        const batch = timeIt(c.batch);
+        const stream = timeIt(() => streaming(wasm, c.native, nativeArgs, closes, c.nativeRead));
+        console.log(`${diff <= TOLERANCE ? '✅' : '❌'} ${c.name.padEnd(8)} js ${js.toFixed(2).padStart(8)} ms  batch ${batch.toFixed(2).padStart(7)} ms` +
+            `  streaming ${stream.toFixed(2).padStart(7)} ms  speedup ${(js / batch).toFixed(1)}x  max diff ${diff.toExponential(1)}`);
+    }
+
+    // Kernels without a JS reference, timed only
+    const highs = closes.map(v => v + 1);
+    const lows = closes.map(v => v - 1);
+    const volumes = closes.map(() => 100);
+    const others = {
+        'EMA(20)': () => wasm.ema(closes, 20),
+        'WMA(20)': () => wasm.wma(closes, 20),
+        'Boll(20)': () => wasm.bollinger(closes, 20, 2),
+        'ATR(14)': () => wasm.atr(highs, lows, closes, 14),
+        'VWAP': () => wasm.vwap(closes, volumes),
+        'Std(20)': () => wasm.rollingStd(closes, 20),
+        'Min(20)': () => wasm.rollingMin(closes, 20),
+        'Max(20)': () => wasm.rollingMax(closes, 20)
+    };
+    for (const [name, fn] of Object.entries(others)) {
+        console.log(`⏱️  ${name.padEnd(8)} batch ${timeIt(fn).toFixed(2).padStart(7)} ms`);
+    }
+
+    service.cleanup();
+    console.log(failures === 0 ? '🎉 Native kernels match the JS reference' : `❌ ${failures} indicator(s) differ from the JS reference`);
+    process.exit(failures === 0 ? 0 : 1);
+}
+
+runBenchmark().catch(error => {
+    console.error('❌ Benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,58 @@
+/**
+ * Native Addon vs WASM Benchmark
+ *
+ * Measures NetPackage encode and decode latency through WasmService for the
+ * WASM build and the N-API addon. Without arguments a fetch-by-code request
+ * frame is used; pass a captured server frame (raw WebSocket message) to
+ * measure decoding of real responses.
+ *
+ * Usage: node bench-native-decode.js [captured-frame.bin]
+ */
+
+import fs from 'fs';
+import WasmService from './src/services/WasmService.js';
+
+const ITERATIONS = parseInt(process.env.BENCH_ITERATIONS || '20000', 10);
+
+function measure(fn) {
+    fn(); // warm up
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < ITERATIONS; i++) {
+        fn();
+    }
+    return Number(process.hrtime.bigint() - start) / 1e3 / ITERATIONS; // microseconds
+}
+
+async function benchBackend(backend, frame) {
+    const service = new WasmService({ backend });
+    await service.initialize();
+    if (service.getBackend() !== backend) {
+        console.log(`⚠️  ${backend} backend not available, skipped`);
+        return null;
+    }
+    const input = frame || service.createHistoricalDataByCodeRequest('bench', 1, 'DCE', 'i<00>', 'SampleQuote', 0, 86400,
+        1700000000000, 1710000000000, ['open', 'close', 'high', 'low', 'volume']);
+
+    const encodeUs = measure(() => service.createUniverseRequest('bench'));
+    const decodeUs = measure(() => service.decodeMessage(input));
+    service.cleanup();
+
+    console.log(`${backend.padEnd(7)} encode ${encodeUs.toFixed(2).padStart(8)} µs   decode ${decodeUs.toFixed(2).padStart(8)} µs   (${input.byteLength} bytes)`);
+    return decodeUs;
+}
+
+async function runBenchmark() {
+    const frame = process.argv[2] ? fs.readFileSync(process.argv[2]) : null;
+    console.log(`📦 ${frame ? process.argv[2] : 'fetch-by-code request frame'}, ${ITERATIONS} iterations`);
+
+    const wasm = await benchBackend('wasm', frame);
+    const native = await benchBackend('native', frame);
+    if (wasm && native) {
+        console.log(`🚀 Native decode speedup: ${(wasm / native).toFixed(2)}x`);
+    }
+}
+
+runBenchmark().catch(error => {
+    console.error('❌ Benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,94 @@
+/**
+ * WASM SIMD Build Benchmark
+ *
+ * Measures fetch decode throughput of the scalar build (public/caitlyn_js.js)
+ * and the -msimd128 build (public/caitlyn_js_simd.js). Each build gets its own
+ * connection; one fetch response is captured per build and decoded repeatedly,
+ * then exported through ATFetchSVRes.columns() when the build provides it.
+ *
+ * Usage: CAITLYN_WS_URL=... CAITLYN_TOKEN=... node bench-wasm-simd.js [market] [code] [qualifiedName] [field,...]
+ */
+
+import fs from 'fs';
+import dotenv from 'dotenv';
+import CaitlynClientConnection from './src/utils/CaitlynClientConnection.js';
+
+dotenv.config();
+
+const CAITLYN_WS_URL = process.env.CAITLYN_WS_URL;
+const TOKEN = process.env.CAITLYN_TOKEN;
+const MARKET = process.argv[2] || 'DCE';
+const CODE = process.argv[3] || 'i<00>';
+const QUALIFIED_NAME = process.argv[4] || 'SampleQuote';
+const FIELDS = (process.argv[5] || 'close,volume').split(',');
+const ITERATIONS = parseInt(process.env.BENCH_ITERATIONS || '20', 10);
+
+const quietLogger = { info() {}, debug() {}, warn: console.warn, error: console.error };
+
+async function benchVariant(variant) {
+    const connection = new CaitlynClientConnection({ url: CAITLYN_WS_URL, token: TOKEN, logger: quietLogger, wasmVariant: variant });
+    await connection.loadWasmModule();
+    if (connection.wasmVariant !== variant) {
+        console.log(`⚠️  ${variant} build not available, skipped`);
+        return null;
+    }
+    const wasm = connection.wasmModule;
+
+    let captured = null;
+    const handleFetch = connection.handleFetchByCodeResponse.bind(connection);
+    connection.handleFetchByCodeResponse = (pkg) => {
+        if (!captured) {
+            captured = pkg.content().slice();
+        }
+        handleFetch(pkg);
+    };
+
+    await connection.connect();
+    await connection.fetchByCode(MARKET, CODE, { qualifiedName: QUALIFIED_NAME, namespace: 0, granularity: 86400, fields: FIELDS });
+
+    let records = 0;
+    const pass = () => {
+        const res = new wasm.ATFetchSVRes();
+        res.setCompressor(connection.compressor);
+        res.decode(captured);
+        if (typeof res.columns === 'function') {
+            records = res.columns(FIELDS).count;
+        } else {
+            const results = res.results();
+            records = results.size();
+            results.delete();
+        }
+        res.delete();
+    };
+
+    pass(); // warm up
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < ITERATIONS; i++) {
+        pass();
+    }
+    const seconds = Number(process.hrtime.bigint() - start) / 1e9 / ITERATIONS;
+    connection.disconnect();
+
+    const mbPerSec = captured.length / seconds / (1024 * 1024);
+    const recordsPerSec = records / seconds;
+    console.log(`${variant.padEnd(7)} ${captured.length.toString().padStart(10)} bytes ${records.toString().padStart(8)} records  ${mbPerSec.toFixed(1).padStart(8)} MB/s ${recordsPerSec.toFixed(0).padStart(10)} records/s`);
+    return recordsPerSec;
+}
+
+async function runBenchmark() {
+    if (!fs.existsSync('./public/caitlyn_js_simd.js')) {
+        console.log('⚠️  public/caitlyn_js_simd.js not found, only the scalar build will be measured');
+    }
+    console.log(`📦 ${MARKET}/${CODE} (${QUALIFIED_NAME}) fields=${FIELDS.join(',')}, ${ITERATIONS} passes, SIMD runtime support: ${CaitlynClientConnection.simdSupported()}`);
+
+    const scalar = await benchVariant('scalar');
+    const simd = await benchVariant('simd');
+    if (scalar && simd) {
+        console.log(`🚀 SIMD speedup: ${(simd / scalar).toFixed(2)}x`);
+    }
+}
+
+runBenchmark().catch(error => {
+    console.error('❌ Benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,51 @@
+{
+  # Native addon build of docs/cxx/caitlyn_js.cpp (see docs/cxx/caitlyn_node.cpp).
+  #
+  #   CAITLYN_SRC=/path/to/caitlyn/include npm run build:native
+  #
+  # CAITLYN_SRC is the include root of the caitlyn protocol and serializer
+  # sources (corestdafx.h, protocol/, go/, utils/) that caitlyn_js.wasm is
+  # built from; CAITLYN_LIBS lists any libraries they need at link time.
+  "variables": {
+    "caitlyn_src%": "<!(node -p \"process.env.CAITLYN_SRC || ''\")",
+    "caitlyn_libs%": "<!(node -p \"process.env.CAITLYN_LIBS || ''\")"
+  },
+  "targets": [
+    {
+      "target_name": "caitlyn_node",
+      "sources": [
+        "../../docs/cxx/caitlyn_js.cpp",
+        "../../docs/cxx/caitlyn_node.cpp"
+      ],
+      # docs/cxx/node first: its emscripten/bind.h maps the bindings onto N-API
+      "include_dirs": [
+        "../../docs/cxx/node",
+        "../../docs/cxx",
+        "<(caitlyn_src)"
+      ],
+      "libraries": [ "<@(caitlyn_libs)" ],
+      "defines": [ "NAPI_VERSION=8" ],
+      "cflags!": [ "-fno-exceptions", "-fno-rtti" ],
+      "cflags_cc!": [ "-fno-exceptions", "-fno-rtti" ],
+      "cflags_cc": [ "-std=c++17", "-fexceptions", "-frtti" ],
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "GCC_ENABLE_CPP_RTTI": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+        "MACOSX_DEPLOYMENT_TARGET": "10.15"
+      }
+    },
+    {
+      # next to caitlyn_js.wasm, where CaitlynNativeModule.js looks for it
+      "target_name": "copy_caitlyn_node",
+      "type": "none",
+      "dependencies": [ "caitlyn_node" ],
+      "copies": [
+        {
+          "destination": "../public",
+          "files": [ "<(PRODUCT_DIR)/caitlyn_node.node" ]
+        }
+      ]
+    }
+  ]
+}
@@ -247,6 +247,11 @@ app.get('/api/futures/:market', async (req, res) => {
 app.get('/api/futures/search/:pattern', async (req, res) => {
   const { pattern } = req.params;
   const { market } = req.query;
+  const native = caitlynService.searchSecurities(pattern, { market, limit: parseInt(req.query.limit, 10) || 0 });
+  if (native) {
+    // Code prefix match on the native SecurityMaster
+    return res.json(native);
+  }
   const securities = caitlynService.getSharedSecurities();
   let results = Object.values(securities).flat().filter(f => 
     f.symbol?.toLowerCase().includes(pattern.toLowerCase()) || 
@@ -1,6 +1,8 @@
 import EventEmitter from 'events';
 import logger from '../utils/logger.js';
 import CaitlynClientConnection from '../utils/CaitlynClientConnection.js';
+import SchemaSnapshotCache from '../utils/SchemaSnapshotCache.js';
+import UniverseSeedsCache from '../utils/UniverseSeedsCache.js';
 
 /**
  * Enhanced Connection Pool using CaitlynClientConnection pattern
@@ -25,6 +27,24 @@ class CaitlynConnectionPool extends EventEmitter {
     this.reconnectDelay = options.reconnectDelay || 5000;
     this.maxReconnectAttempts = options.maxReconnectAttempts || 3;
     
+    // Schema sharing: one parse (or snapshot load) per schema payload
+    this.schemaCache = new SchemaSnapshotCache({
+      directory: options.schemaCacheDir || process.env.CAITLYN_SCHEMA_CACHE_DIR || null,
+      logger: logger
+    });
+    // Seeds of unchanged universe revisions are reused across connections and restarts
+    this.universeCache = new UniverseSeedsCache({
+      directory: options.universeCacheDir || process.env.CAITLYN_UNIVERSE_CACHE_DIR || null,
+      logger: logger
+    });
+    // Per connection BarCache capacity in bytes, 0 fetches every range from the server
+    this.barCacheBytes = options.barCacheBytes ?? (process.env.CAITLYN_BAR_CACHE_BYTES ? Number(process.env.CAITLYN_BAR_CACHE_BYTES) : undefined);
+    // One WASM instance for all connections, so they also share the parsed schema
+    this.shareWasmModule = options.shareWasmModule || false;
+    this.backend = options.backend; // 'wasm' | 'native', CAITLYN_BACKEND when unset
+    this.nativePath = options.nativePath;
+    this.sharedModulePromise = null;
+    
     // Pool state
     this.connections = new Map(); // connectionId -> CaitlynClientConnection
     this.availableConnections = new Set(); // Set of connection IDs
@@ -88,6 +108,27 @@ class CaitlynConnectionPool extends EventEmitter {
     }
   }
 
+  /**
+   * Load the WASM module of a connection; with shareWasmModule the first
+   * connection loads it and the others reuse that instance
+   */
+  async loadConnectionModule(connection, wasmJsPath, wasmPath) {
+    if (!this.shareWasmModule) {
+      return connection.loadWasmModule(wasmJsPath, wasmPath);
+    }
+    if (!this.sharedModulePromise) {
+      this.sharedModulePromise = connection.loadWasmModule(wasmJsPath, wasmPath)
+        .then(() => connection.wasmModule)
+        .catch(error => {
+          this.sharedModulePromise = null;
+          throw error;
+        });
+      return this.sharedModulePromise;
+    }
+    connection.sharedWasmModule = await this.sharedModulePromise;
+    return connection.loadWasmModule(wasmJsPath, wasmPath);
+  }
+
   /**
    * Create a new CaitlynClientConnection instance
    */
@@ -101,7 +142,12 @@ class CaitlynConnectionPool extends EventEmitter {
       const connection = new CaitlynClientConnection({
         url: this.url,
         token: this.token,
-        logger: logger
+        logger: logger,
+        schemaCache: this.schemaCache,
+        universeCache: this.universeCache,
+        barCacheBytes: this.barCacheBytes,
+        backend: this.backend,
+        nativePath: this.nativePath
       });
 
       // Set up event handlers
@@ -114,7 +160,7 @@ class CaitlynConnectionPool extends EventEmitter {
 
       const initPromise = (async () => {
         // Load WASM module
-        await connection.loadWasmModule(wasmJsPath, wasmPath);
+        await this.loadConnectionModule(connection, wasmJsPath, wasmPath);
         logger.info(`✅ WASM loaded for connection ${connectionId}`);
         
         // Connect and initialize
@@ -430,6 +476,31 @@ class CaitlynConnectionPool extends EventEmitter {
     return this.sharedSecurities;
   }
 
+  /**
+   * Code prefix search on the SecurityMaster of the first connection that has one
+   * @returns {Array|null} Matches, null when no connection has a SecurityMaster
+   */
+  searchSecurities(prefix, options = {}) {
+    for (const connection of this.connections.values()) {
+      if (connection.securityMaster) {
+        return connection.searchSecurities(prefix, options);
+      }
+    }
+    return null;
+  }
+
+  /**
+   * (market, code) lookup on the SecurityMaster of the first connection that has one
+   */
+  lookupSecurity(market, code) {
+    for (const connection of this.connections.values()) {
+      if (connection.securityMaster) {
+        return connection.lookupSecurity(market, code);
+      }
+    }
+    return null;
+  }
+
   /**
    * Get pool statistics
    */
@@ -480,6 +551,9 @@ class CaitlynConnectionPool extends EventEmitter {
     this.busyConnections.clear();
     
     // Clear shared data
+    this.schemaCache.release();
+    this.universeCache.release();
+    this.sharedModulePromise = null;
     this.sharedSchema = null;
     this.sharedMarkets = null;
     this.sharedSecurities = null;
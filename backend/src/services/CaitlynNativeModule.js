@@ -0,0 +1,37 @@
+import fs from 'fs';
+import path from 'path';
+import { createRequire } from 'module';
+import { fileURLToPath } from 'url';
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+export const DEFAULT_NATIVE_PATH = path.join(__dirname, '../../public/caitlyn_node.node');
+
+const nativeModules = new WeakSet();
+
+/**
+ * Load public/caitlyn_node.node (or addonPath), built by `npm run build:native`
+ * The addon is compiled from the same EMSCRIPTEN_BINDINGS block as
+ * caitlyn_js.wasm, so it exports the same classes, enums and functions and is
+ * used in place of the module returned by CaitlynModule()
+ * @returns {Object|null} the addon exports, null when the addon is missing
+ */
+export function loadNativeModule(addonPath = DEFAULT_NATIVE_PATH) {
+  if (!fs.existsSync(addonPath)) {
+    return null;
+  }
+  const addon = require(path.resolve(addonPath));
+  nativeModules.add(addon);
+  return addon;
+}
+
+/**
+ * Whether module came from loadNativeModule() rather than CaitlynModule()
+ */
+export function isNativeModule(module) {
+  return module != null && nativeModules.has(module);
+}
+
+export default loadNativeModule;
@@ -196,6 +196,14 @@ class CaitlynWebSocketService {
     return this.sharedSecurities || this.connectionPool?.getSharedSecurities();
   }
 
+  searchSecurities(prefix, options = {}) {
+    return this.connectionPool?.searchSecurities(prefix, options) ?? null;
+  }
+
+  lookupSecurity(market, code) {
+    return this.connectionPool?.lookupSecurity(market, code) ?? null;
+  }
+
   createClientHandler(frontendWs) {
     const client = new ClientHandler(frontendWs, this.poolConfig, this);
     this.clients.add(client);
@@ -3,12 +3,21 @@ import path from 'path';
 import { fileURLToPath } from 'url';
 import logger from '../utils/logger.js';
 import { createSingularityObject } from '../utils/SingularityObjects.js';
+import { loadNativeModule } from './CaitlynNativeModule.js';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 
 class WasmService {
-  constructor() {
+  /**
+   * @param {Object} options
+   * @param {string} options.backend - 'wasm' (default) or 'native'; CAITLYN_BACKEND overrides the default
+   * @param {string} options.nativePath - Path of the N-API addon, defaults to public/caitlyn_node.node
+   */
+  constructor(options = {}) {
+    this.backendOption = options.backend || process.env.CAITLYN_BACKEND || 'wasm';
+    this.nativePath = options.nativePath;
+    this.backend = null; // Backend actually loaded
     this.module = null;
     this.schema = null; // Public schema for frontend
     this.schemaByNamespace = null; // Internal schema for processing
@@ -19,6 +28,22 @@ class WasmService {
   }
 
   async initialize() {
+    if (this.backendOption === 'native') {
+      try {
+        this.module = loadNativeModule(this.nativePath);
+      } catch (error) {
+        logger.warn(`Native addon failed to load, falling back to WASM: ${error.message}`);
+      }
+      if (this.module) {
+        this.backend = 'native';
+        this.verifyModule();
+        logger.info('Native addon loaded successfully');
+        this.ready = true;
+        return;
+      }
+      logger.warn('Native addon not found, falling back to WASM');
+    }
+
     // Load the WASM module
     const wasmPath = path.join(__dirname, '../../public/caitlyn_js.wasm');
     const jsPath = path.join(__dirname, '../../public/caitlyn_js.js');
@@ -44,8 +69,15 @@ class WasmService {
         }
       }).catch(reject);
     });
+    this.backend = 'wasm';
+    this.verifyModule();
     
-    // Verify essential classes are available
+    logger.info('WASM module loaded successfully');
+    this.ready = true;
+  }
+
+  // Verify essential classes are available
+  verifyModule() {
     const requiredClasses = [
       'NetPackage',
       'IndexSchema',
@@ -58,18 +90,20 @@ class WasmService {
     
     for (const className of requiredClasses) {
       if (!this.module[className]) {
-        throw new Error(`Required class ${className} not found in WASM module`);
+        throw new Error(`Required class ${className} not found in ${this.backend} module`);
       }
     }
-    
-    logger.info('WASM module loaded successfully');
-    this.ready = true;
   }
 
   isReady() {
     return this.ready;
   }
 
+  // 'wasm' or 'native', null before initialize()
+  getBackend() {
+    return this.backend;
+  }
+
   getModule() {
     if (!this.ready) {
       throw new Error('WASM module not initialized');
@@ -16,10 +16,14 @@
  */
 
 import ws from 'nodejs-websocket';
+import fs from 'fs';
 import path from 'path';
 import { createSingularityObject } from './SingularityObjects.js';
 import SVObject from './StructValueWrapper.js';
 import CaitlynSubscriptionHub from './CaitlynSubscriptionHub.js';
+import SchemaSnapshotCache from './SchemaSnapshotCache.js';
+import UniverseSeedsCache from './UniverseSeedsCache.js';
+import { loadNativeModule, isNativeModule } from '../services/CaitlynNativeModule.js';
 
 class CaitlynClientConnection {
   constructor(options = {}) {
@@ -37,6 +41,27 @@ class CaitlynClientConnection {
     // WASM module and processing
     this.wasmModule = null;
     this.compressor = null;
+    this.frameDecoder = null; // Reusable NetPackageDecoder (arena-backed)
+    this.pendingFrames = []; // Raw frames waiting for the next batched decode
+    this.fetchChunkSize = options.fetchChunkSize || 10000; // Records per ATFetchSVResReader chunk
+    this.snapshotStore = null; // Latest subscription rows (SubscriptionSnapshotStore)
+    this.securityMaster = null; // Native (market, code) and code prefix index (SecurityMaster)
+    this.barCacheBytes = options.barCacheBytes ?? 64 * 1024 * 1024; // BarCache capacity, 0 disables it
+    this.barCache = null; // Fetched bars, fetchByCode asks only for missing ranges (BarCache)
+    this.fetchGapTimeout = options.fetchGapTimeout || 30000; // ms before a bar cache gap request is given up
+    this.wasmVariantOption = options.wasmVariant || 'auto'; // 'auto' | 'simd' | 'scalar'
+    this.wasmVariant = null; // Build actually loaded
+    this.backendOption = options.backend || process.env.CAITLYN_BACKEND || 'wasm'; // 'wasm' | 'native'
+    this.nativePath = options.nativePath; // N-API addon, defaults to public/caitlyn_node.node
+    this.backend = null; // Backend actually loaded, 'wasm' or 'native'
+    this.decodeThreads = options.decodeThreads ?? 2; // DecodePool workers, 0 decodes on the main thread
+    this.poolDecodeThreshold = options.poolDecodeThreshold || 256 * 1024; // Payload bytes worth a worker
+    this.decodePool = null; // DecodePool, pthread builds only
+    this.decodeWaiters = new Map(); // Map<ticket, {kind, resolve}>
+    this.sharedWasmModule = options.wasmModule || null; // Module instance loaded by another connection
+    this.schemaCache = options.schemaCache || null; // SchemaSnapshotCache shared with other connections
+    this.universeCache = options.universeCache || null; // UniverseSeedsCache shared with other connections
+    this.schemaKey = null; // SchemaSnapshotCache.keyOf() the schema payload, ties cached seeds to it
     this.schema = {};
     this.schemaByNamespace = {};
     
@@ -48,6 +73,7 @@ class CaitlynClientConnection {
     this.sequenceId = 3;
     this.expectedSeedsResponses = 0;
     this.receivedSeedsResponses = 0;
+    this.seedsRequests = new Map(); // Map<sequenceId, seeds request>, for the universe cache
     
     // Async query cache for tracking request-response mapping
     this.queryCache = new Map(); // Map<sequenceId, queryInfo>
@@ -75,6 +101,9 @@ class CaitlynClientConnection {
 
   /**
    * Load and initialize the WASM module
+   * With options.backend 'native' (or CAITLYN_BACKEND=native) the N-API addon
+   * built from the same bindings is loaded instead, falling back to WASM when
+   * it is missing or fails to load
    * @param {string} wasmJsPath - Path to caitlyn_js.js
    * @param {string} wasmPath - Path to caitlyn_js.wasm
    */
@@ -96,11 +125,23 @@ class CaitlynClientConnection {
         resolvedPath = wasmJsPath;
       }
       
-      this.logger.debug(`Resolving WASM path: ${wasmJsPath} -> ${resolvedPath}`);
-      const CaitlynModule = await import(resolvedPath);
-      this.wasmModule = await CaitlynModule.default();
-      
-      this.logger.info('✅ WASM module loaded successfully!');
+      if (this.sharedWasmModule) {
+        // Reuse the instance of another connection (and its parsed schema)
+        this.wasmModule = this.sharedWasmModule;
+        this.backend = isNativeModule(this.wasmModule) ? 'native' : 'wasm';
+        this.wasmVariant = this.wasmModule.simdEnabled?.() ? 'simd' : 'scalar';
+        this.logger.info(`✅ Using shared ${this.backend} module (${this.wasmVariant} build)`);
+      } else if (this.backendOption === 'native' && this.loadNativeBackend()) {
+        this.logger.info('✅ Native addon loaded successfully!');
+      } else {
+        this.backend = 'wasm';
+        resolvedPath = this.resolveWasmVariant(resolvedPath);
+        this.logger.debug(`Resolving WASM path: ${wasmJsPath} -> ${resolvedPath}`);
+        const CaitlynModule = await import(resolvedPath);
+        this.wasmModule = await CaitlynModule.default();
+        
+        this.logger.info(`✅ WASM module loaded successfully! (${this.wasmVariant} build)`);
+      }
       
       // Verify essential classes
       const requiredClasses = [
@@ -120,6 +161,33 @@ class CaitlynClientConnection {
         }
       }
       
+      // Optional: arena-backed frame decoder (older WASM builds fall back to NetPackage)
+      if (typeof this.wasmModule.NetPackageDecoder === "function") {
+        this.frameDecoder = new this.wasmModule.NetPackageDecoder();
+        this.logger.info('✅ NetPackageDecoder available, reusing decode arena per connection.');
+      }
+      if (typeof this.wasmModule.SubscriptionSnapshotStore === "function") {
+        this.snapshotStore = new this.wasmModule.SubscriptionSnapshotStore();
+      }
+      if (typeof this.wasmModule.SecurityMaster === "function") {
+        this.securityMaster = new this.wasmModule.SecurityMaster();
+      }
+      if (typeof this.wasmModule.BarCache === "function" && this.barCacheBytes > 0) {
+        this.barCache = new this.wasmModule.BarCache(this.barCacheBytes);
+      }
+      // Optional: worker decode pool, only worth keeping on a -pthread build
+      if (typeof this.wasmModule.DecodePool === "function" && this.decodeThreads > 0) {
+        this.decodePool = new this.wasmModule.DecodePool(this.decodeThreads);
+        if (this.decodePool.threads() === 0) {
+          this.decodePool.delete();
+          this.decodePool = null;
+        } else {
+          // called on the main thread each time a worker finishes a payload
+          this.decodePool.setListener(() => this.pumpDecodePool());
+          this.logger.info(`✅ DecodePool available, ${this.decodePool.threads()} decode threads.`);
+        }
+      }
+      
       return true;
     } catch (error) {
       this.logger.error('❌ Failed to load WASM module:', error);
@@ -127,6 +195,65 @@ class CaitlynClientConnection {
     }
   }
 
+  /**
+   * Load the N-API addon (caitlyn_node.node) as this connection's module
+   * @returns {boolean} false when it is missing or fails to load
+   */
+  loadNativeBackend() {
+    try {
+      const addon = loadNativeModule(this.nativePath);
+      if (!addon) {
+        this.logger.warn('⚠️ Native addon not found, falling back to WASM');
+        return false;
+      }
+      this.wasmModule = addon;
+      this.backend = 'native';
+      this.wasmVariant = addon.simdEnabled?.() ? 'simd' : 'scalar';
+      return true;
+    } catch (error) {
+      this.logger.warn(`⚠️ Native addon failed to load, falling back to WASM: ${error.message}`);
+      return false;
+    }
+  }
+
+  /**
+   * Pick the -msimd128 build (caitlyn_js_simd.js next to caitlyn_js.js) when
+   * the runtime supports WASM SIMD, otherwise keep the scalar build
+   * Set options.wasmVariant to 'scalar' or 'simd' to force one
+   */
+  resolveWasmVariant(resolvedPath) {
+    this.wasmVariant = 'scalar';
+    if (this.wasmVariantOption === 'scalar' || !resolvedPath.endsWith('.js')) {
+      return resolvedPath;
+    }
+    const simdPath = resolvedPath.replace(/\.js$/, '_simd.js');
+    if (!fs.existsSync(simdPath)) {
+      return resolvedPath;
+    }
+    if (this.wasmVariantOption !== 'simd' && !CaitlynClientConnection.simdSupported()) {
+      this.logger.info('ℹ️ WASM SIMD not supported by this runtime, using scalar build');
+      return resolvedPath;
+    }
+    this.wasmVariant = 'simd';
+    return simdPath;
+  }
+
+  /**
+   * Whether the runtime validates a module using a v128 instruction
+   */
+  static simdSupported() {
+    // (module (func (result v128) i32.const 0 i8x16.splat i8x16.popcnt))
+    const probe = new Uint8Array([
+      0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10,
+      10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+    ]);
+    try {
+      return WebAssembly.validate(probe);
+    } catch (error) {
+      return false;
+    }
+  }
+
   /**
    * Connect to Caitlyn server and perform full initialization
    */
@@ -197,35 +324,116 @@ class CaitlynClientConnection {
       });
       
       stream.on("end", () => {
-        try {
-          // Convert Buffer to ArrayBuffer
-          const _buf = this.bufferToArrayBuffer(buf);
-          const pkg = new this.wasmModule.NetPackage();
-          pkg.decode(_buf);
-          
-          // Log non-keepalive messages
-          if (pkg.header.cmd !== this.wasmModule.NET_CMD_GOLD_ROUTE_KEEPALIVE && 
-              pkg.header.cmd !== this.wasmModule.CMD_TA_MARKET_STATUS) {
-            this.logger.info(`📦 Message: cmd=${this.getCommandName(pkg.header.cmd)} (${pkg.header.cmd}), content_len=${pkg.length()}`);
-          }
-          
-          // Route messages
-          this.handleBinaryMessage(pkg, resolve, reject);
-          
-          // Cleanup
-          pkg.delete();
-          
-        } catch (error) {
-          this.logger.error('Error processing binary message:', error);
-          this.emit('error', error);
-          if (!this.isInitialized) {
-            reject(error);
-          }
+        // Frames arriving in the same tick are decoded together in one WASM call
+        this.pendingFrames.push(buf);
+        if (this.pendingFrames.length === 1) {
+          setImmediate(() => this.flushPendingFrames(resolve, reject));
         }
       });
     });
   }
 
+  /**
+   * Decode and route all frames queued since the last flush
+   */
+  flushPendingFrames(resolve, reject) {
+    const frames = this.pendingFrames;
+    this.pendingFrames = [];
+    
+    if (frames.length > 1 && this.frameDecoder && typeof this.frameDecoder.decodeFrames === 'function') {
+      this.dispatchFrameBatch(frames, resolve, reject);
+      return;
+    }
+    
+    for (const buf of frames) {
+      try {
+        // Convert Buffer to ArrayBuffer
+        const _buf = this.bufferToArrayBuffer(buf);
+        
+        // The decoder exposes the same header/content()/length() surface as NetPackage;
+        // its content view stays valid until the next frame is decoded
+        const pkg = this.frameDecoder || new this.wasmModule.NetPackage();
+        pkg.decode(_buf);
+        
+        this.dispatchFrame(pkg, resolve, reject);
+        
+        // Cleanup (the shared decoder lives until disconnect)
+        if (pkg !== this.frameDecoder) {
+          pkg.delete();
+        }
+      } catch (error) {
+        this.handleFrameError(error, reject);
+      }
+    }
+  }
+
+  /**
+   * Decode a batch of frames with NetPackageDecoder.decodeFrames and route each one
+   * Table rows are (cmd, content offset, content length) into the decoder arena
+   */
+  dispatchFrameBatch(frames, resolve, reject) {
+    let table;
+    const offsets = new Uint32Array(frames.length);
+    let total = 0;
+    for (let i = 0; i < frames.length; i++) {
+      offsets[i] = total;
+      total += frames[i].length;
+    }
+    
+    try {
+      table = this.frameDecoder.decodeFrames(Buffer.concat(frames, total), offsets).slice();
+    } catch (error) {
+      this.handleFrameError(error, reject);
+      return;
+    }
+    
+    for (let i = 0; i < table.length; i += 3) {
+      const cmd = table[i];
+      const offset = table[i + 1];
+      const length = table[i + 2];
+      if (length < 0) {
+        this.logger.warn(`⚠️ Dropping malformed frame ${i / 3} in batch of ${frames.length}`);
+        continue;
+      }
+      
+      // Re-acquire the arena view on access: WASM memory growth detaches older views
+      const frameDecoder = this.frameDecoder;
+      const pkg = {
+        header: { cmd },
+        length: () => length,
+        content: () => frameDecoder.arena().subarray(offset, offset + length)
+      };
+      
+      try {
+        this.dispatchFrame(pkg, resolve, reject);
+      } catch (error) {
+        this.handleFrameError(error, reject);
+      }
+    }
+  }
+
+  /**
+   * Log and route one decoded frame
+   */
+  dispatchFrame(pkg, resolve, reject) {
+    // Log non-keepalive messages
+    if (pkg.header.cmd !== this.wasmModule.NET_CMD_GOLD_ROUTE_KEEPALIVE && 
+        pkg.header.cmd !== this.wasmModule.CMD_TA_MARKET_STATUS) {
+      this.logger.info(`📦 Message: cmd=${this.getCommandName(pkg.header.cmd)} (${pkg.header.cmd}), content_len=${pkg.length()}`);
+    }
+    
+    // Route messages
+    this.handleBinaryMessage(pkg, resolve, reject);
+  }
+
+  handleFrameError(error, reject) {
+    this.logger.error('Error processing binary message:', error);
+    this.emit('error', error);
+    if (!this.isInitialized) {
+      reject(error);
+    }
+  }
+
   /**
    * Handle binary message routing
    */
@@ -292,9 +500,19 @@ class CaitlynClientConnection {
   handleSchemaDefinition(pkg) {
     this.logger.info('🏗️ ===== SCHEMA PROCESSING =====');
     
-    // Create and load schema
-    const schema = new this.wasmModule.IndexSchema();
-    schema.load(pkg.content());
+    // Create and load schema, from the shared cache when there is one
+    let schema;
+    if (this.universeCache) {
+      this.schemaKey = SchemaSnapshotCache.keyOf(pkg.content());
+    }
+    if (this.schemaCache) {
+      const acquired = this.schemaCache.acquire(this.wasmModule, pkg.content());
+      schema = acquired.schema;
+      this.logger.info(`📋 Schema ${acquired.source === 'parsed' ? 'parsed' : `loaded (${acquired.source})`}`);
+    } else {
+      schema = new this.wasmModule.IndexSchema();
+      schema.load(pkg.content());
+    }
     const metas = schema.metas();
     
     this.logger.info(`📋 Loading ${metas.size()} metadata definitions...`);
@@ -384,13 +602,30 @@ class CaitlynClientConnection {
     this.logger.info(`   - Global namespace (0): ${Object.keys(this.schema[0] || {}).length} metadata definitions`);
     this.logger.info(`   - Private namespace (1): ${Object.keys(this.schema[1] || {}).length} metadata definitions`);
     
-    // Initialize compressor
-    this.compressor = new this.wasmModule.IndexSerializer();
-    this.compressor.updateSchema(schema);
-    this.logger.info("🔧 IndexSerializer initialized with schema");
+    // Initialize compressor; a re-pushed definition only applies the metas that changed,
+    // older revisions stay decodable for responses already in flight
+    if (this.compressor && typeof this.compressor.applySchemaDelta === 'function') {
+      const applied = this.compressor.applySchemaDelta(metas);
+      if (this.decodePool && applied > 0) {
+        const merged = this.compressor.currentSchema();
+        this.decodePool.setSchema(merged);
+        merged.delete();
+      }
+      this.logger.info(`🔧 Schema delta applied: ${applied} metadata definitions added or replaced`);
+    } else {
+      this.compressor = new this.wasmModule.IndexSerializer();
+      this.compressor.updateSchema(schema);
+      if (this.decodePool) {
+        this.decodePool.setSchema(schema);
+      }
+      this.logger.info("🔧 IndexSerializer initialized with schema");
+    }
     
     // Clean up schema object - this should fix the memory leak
-    schema.delete();
+    // (cached schemas are owned by the cache)
+    if (!this.schemaCache) {
+      schema.delete();
+    }
     
     this.emit('schema_loaded', { schema: this.schema, schemaByNamespace: this.schemaByNamespace });
     
@@ -522,6 +757,11 @@ class CaitlynClientConnection {
     this.logger.info('🌱 ===== UNIVERSE SEEDS REQUESTS =====');
     
     let requestsSent = 0;
+    const cached = []; // requests answered by the universe cache
+    const seedsCache = this.universeCache
+      ? this.universeCache.acquire(this.wasmModule, this.schemaKey, UniverseSeedsCache.scopeOf(this.url, this.token))
+      : null;
+    this.seedsRequests.clear();
     
     // Process each namespace and market
     for (const namespaceStr in marketsData) {
@@ -536,8 +776,18 @@ class CaitlynClientConnection {
           // Send seeds request for each qualified_name
           for (const qualifiedName in marketInfo.revisions) {
             const revision = marketInfo.revisions[qualifiedName];
+            const request = { namespace: namespaceStr, market: marketCode, qualifiedName, revision, tradeDay: marketInfo.trade_day };
+            
+            if (seedsCache && seedsCache.isFresh(namespaceStr, marketCode, qualifiedName, revision, marketInfo.trade_day)) {
+              this.logger.debug(`    💾 Seeds cached: ${qualifiedName} (rev: ${revision})`);
+              cached.push(request);
+              continue;
+            }
             
             this.logger.debug(`    📤 Seeds request: ${qualifiedName} (rev: ${revision})`);
+            if (seedsCache) {
+              this.seedsRequests.set(this.sequenceId, request);
+            }
             
             const seedsReq = new this.wasmModule.ATUniverseSeedsReq(
               this.token,
@@ -565,18 +815,52 @@ class CaitlynClientConnection {
       }
     }
     
-    this.logger.info(`✅ Universe seeds requests completed: ${requestsSent} requests sent`);
-    this.expectedSeedsResponses = requestsSent;
+    this.logger.info(`✅ Universe seeds requests completed: ${requestsSent} requests sent, ${cached.length} served from cache`);
+    this.expectedSeedsResponses = requestsSent + cached.length;
+    
+    // Seeds of unchanged revisions are decoded from the cache, as if just received
+    for (const request of cached) {
+      const res = new this.wasmModule.ATUniverseSeedsRes();
+      res.setCompressor(this.compressor);
+      res.decode(seedsCache.seeds(request.namespace, request.market, request.qualifiedName));
+      this.processUniverseSeeds(res);
+    }
   }
 
   /**
    * Handle universe seeds response
    */
   handleUniverseSeeds(pkg) {
+    // The payload is kept for the universe cache; frame decoder views do not outlive this call
+    const content = this.seedsRequests.size > 0 ? pkg.content().slice() : null;
+    if (this.usePoolDecode(pkg)) {
+      this.decodeInPool(this.wasmModule.DECODE_SEEDS, pkg.content())
+        .then(res => this.processUniverseSeeds(res, content))
+        .catch(error => this.logger.error('❌ Seeds decode failed:', error.message));
+      return;
+    }
     const res = new this.wasmModule.ATUniverseSeedsRes();
     res.setCompressor(this.compressor);
     res.decode(pkg.content());
-    
+    this.processUniverseSeeds(res, content);
+  }
+
+  /**
+   * Index the securities of a decoded ATUniverseSeedsRes, then delete it
+   * @param {Object} res - Decoded ATUniverseSeedsRes
+   * @param {Uint8Array} content - Payload it was decoded from, stored in the universe cache
+   */
+  processUniverseSeeds(res, content = null) {
+    const request = content ? this.seedsRequests.get(res.seq) : null;
+    if (request) {
+      this.seedsRequests.delete(res.seq);
+      if (res.errorCode === 0) {
+        this.universeCache.store(this.wasmModule, request, content);
+      }
+    }
+    if (this.securityMaster) {
+      this.securityMaster.add(res);
+    }
     const seedData = res.seedData();
     this.logger.debug(`📊 Received seeds response with ${seedData.size()} entries`);
     
@@ -650,6 +934,9 @@ class CaitlynClientConnection {
     // Check if all responses received
     if (this.receivedSeedsResponses >= this.expectedSeedsResponses) {
       this.logger.info('🎉 All universe seeds responses received');
+      if (this.universeCache) {
+        this.universeCache.persist(this.wasmModule);
+      }
       this.emit('seeds_loaded', { securities: this.securitiesByMarket });
     }
   }
@@ -661,10 +948,22 @@ class CaitlynClientConnection {
   handleFetchByCodeResponse(pkg) {
     this.logger.info('📥 ===== FETCH RESPONSE (ASYNC QUERY PIPELINE) =====');
     
+    if (this.usePoolDecode(pkg)) {
+      this.decodeInPool(this.wasmModule.DECODE_FETCH, pkg.content())
+        .then(res => this.processFetchResponse(res))
+        .catch(error => this.logger.error('❌ Fetch decode failed:', error.message));
+      return;
+    }
     const res = new this.wasmModule.ATFetchSVRes();
     res.setCompressor(this.compressor);
     res.decode(pkg.content());
-    
+    this.processFetchResponse(res);
+  }
+
+  /**
+   * Resolve the cached query of a decoded ATFetchSVRes; takes ownership of res
+   */
+  processFetchResponse(res) {
     this.logger.info(`🔍 Response decode completed, checking results availability...`);
     this.logger.info(`🔍 Response seq: ${res.seq}`);
     this.logger.info(`🔍 Response status: ${res.status}`);
@@ -693,6 +992,43 @@ class CaitlynClientConnection {
       return;
     }
     
+    // Bar cache gap: the records go to the cache, fetchByCodeCached reads them back
+    if (queryInfo.type === 'barCacheGap') {
+      const written = this.barCache ? this.barCache.merge(queryInfo.request, res, queryInfo.coverTo) : 0;
+      res.delete();
+      this.queryCache.delete(responseSeq);
+      this.logger.info(`📦 Bar cache gap seq=${responseSeq}: ${written} bars merged`);
+      queryInfo.resolve(written);
+      return;
+    }
+    
+    // Chunked columnar path: the event loop is released between chunks
+    let columnar = typeof res.columns === 'function' && Array.isArray(queryInfo.fields);
+    if (columnar && typeof this.wasmModule.ATFetchSVResReader === 'function') {
+      const reader = new this.wasmModule.ATFetchSVResReader(res, queryInfo.fields, this.fetchChunkSize);
+      if (reader.complete()) {
+        // The reader holds its own references to the records
+        res.delete();
+        this.readFetchChunks(reader, responseSeq, queryInfo, [], { markets: [], codes: [] });
+        return;
+      }
+      // columns() binds the same fields, only the per-StructValue path is left
+      reader.delete();
+      columnar = false;
+    }
+    
+    // Columnar fast path: one native pass instead of per-field embind getters
+    const coversFields = (columns) => columns && queryInfo.fields.every(name => columns.fields[name] !== undefined);
+    if (columnar) {
+      const columns = res.columns(queryInfo.fields);
+      if (coversFields(columns)) {
+        res.delete();
+        this.logger.info(`📦 Received ${columns.count} StructValues from server (columnar decode)`);
+        this.completeFetchQuery(responseSeq, queryInfo, this.recordsFromColumns(columns, queryInfo), columns.count);
+        return;
+      }
+    }
+    
     this.logger.info(`🔍 Attempting to access results...`);
     const results = res.results();
     const resultCount = results.size();
@@ -715,6 +1051,8 @@ class CaitlynClientConnection {
       this.logger.info(`✅ Configured SVObject: ${svObject.metaName} (namespace: ${queryInfo.namespace})`);
       
       svObject.loadDefFromDict(this.schemaByNamespace);
+      // Skip the embind getters of fields the query did not ask for
+      svObject.setProjection(Array.isArray(queryInfo.fields) ? queryInfo.fields : null);
       
       const maxDisplay = resultCount; // Process all records instead of limiting to 5
       
@@ -795,6 +1133,70 @@ class CaitlynClientConnection {
     
     res.delete();
     
+    this.completeFetchQuery(responseSeq, queryInfo, records, resultCount);
+  }
+
+  /**
+   * Build fetch records from ATFetchSVRes.columns() output
+   * Produces the same record shape as the per-StructValue path
+   */
+  recordsFromColumns(columns, queryInfo) {
+    const records = new Array(columns.count);
+    const fieldNames = Object.keys(columns.fields);
+    
+    for (let i = 0; i < columns.count; i++) {
+      const fields = {};
+      for (const name of fieldNames) {
+        const value = columns.fields[name][i];
+        fields[name] = typeof value === 'bigint' ? String(value) : value;
+      }
+      
+      records[i] = {
+        market: columns.marketDict[columns.markets[i]] || 'unknown',
+        code: columns.codeDict[columns.codes[i]] || 'unknown',
+        timestamp: String(columns.timeTags[i]),
+        metaID: columns.metaID,
+        namespace: columns.namespace,
+        metaName: queryInfo.qualifiedName,
+        fieldCount: columns.fieldCount,
+        granularity: queryInfo.granularity,
+        fields: fields,
+        queryInfo: queryInfo
+      };
+    }
+    
+    return records;
+  }
+
+  /**
+   * Drain an ATFetchSVResReader one chunk per event-loop turn
+   * Chunks only carry the market/code dictionary entries they introduce;
+   * dicts accumulates them so indices resolve across chunks
+   */
+  readFetchChunks(reader, responseSeq, queryInfo, records, dicts) {
+    const chunk = reader.next();
+    if (chunk === null) {
+      const count = reader.count();
+      reader.delete();
+      this.logger.info(`📦 Received ${count} StructValues from server (chunked columnar decode)`);
+      this.completeFetchQuery(responseSeq, queryInfo, records, count);
+      return;
+    }
+    
+    dicts.markets.push(...chunk.marketDict);
+    dicts.codes.push(...chunk.codeDict);
+    const columns = { ...chunk, marketDict: dicts.markets, codeDict: dicts.codes };
+    for (const record of this.recordsFromColumns(columns, queryInfo)) {
+      records.push(record);
+    }
+    
+    setImmediate(() => this.readFetchChunks(reader, responseSeq, queryInfo, records, dicts));
+  }
+
+  /**
+   * Resolve a pending fetch query and release its cache entry
+   */
+  completeFetchQuery(responseSeq, queryInfo, records, resultCount) {
     // Resolve the Promise with the decoded records
     if (queryInfo.resolve) {
       queryInfo.resolve({
@@ -1038,6 +1440,14 @@ class CaitlynClientConnection {
         return;
       }
 
+      // Fold the batch into the latest-value snapshot; listeners read only the changed rows
+      if (this.snapshotStore) {
+        const changedRows = this.snapshotStore.apply(res);
+        if (changedRows > 0) {
+          this.emit('snapshot_changed', { store: this.snapshotStore, changedRows });
+        }
+      }
+
       // Process StructValues using same approach as fetchByCode
       const structValues = res.values();
       if (!structValues || structValues.size() === 0) {
@@ -1397,6 +1807,17 @@ class CaitlynClientConnection {
       throw new Error('qualifiedName is required for generic fetch operations');
     }
     
+    if (this.barCache && options.cache !== false && fields.length > 0) {
+      const cached = await this.fetchByCodeCached(market, code, {
+        qualifiedName, namespace, granularity, fromDate, toDate, fields, revision,
+        fromTimeTag: fromTime ? (fromTime * 1000).toString() : fromDate.getTime().toString(),
+        toTimeTag: toTime ? (toTime * 1000).toString() : toDate.getTime().toString()
+      });
+      if (cached) {
+        return cached;
+      }
+    }
+    
     const currentSeqId = ++this.sequenceId;
     
     this.logger.info(`📤 Generic fetch request: ${market}/${code} (${qualifiedName}) seq=${currentSeqId}`);
@@ -1483,6 +1904,115 @@ class CaitlynClientConnection {
     });
   }
 
+  /**
+   * fetchByCode through the bar cache: fetch only the ranges it lacks, then
+   * serve the whole range from it. Resolves null when the query can't be
+   * cached (unknown meta or revision, non-numeric fields) or a gap request
+   * fails or times out; fetchByCode then fetches the range directly.
+   */
+  async fetchByCodeCached(market, code, params) {
+    const request = new this.wasmModule.ATFetchByCodeReq();
+    request.namespace = params.namespace.toString();
+    request.qualifiedName = params.qualifiedName;
+    request.revision = params.revision;
+    request.market = market;
+    request.code = code;
+    request.granularity = params.granularity;
+    request.fromTimeTag = params.fromTimeTag;
+    request.toTimeTag = params.toTimeTag;
+    
+    try {
+      const gaps = this.barCache.plan(request, params.fields);
+      if (gaps === null) {
+        return null;
+      }
+      
+      this.logger.info(`🗄️ Bar cache ${market}/${code} (${params.qualifiedName}): ${gaps.length} missing ranges`);
+      // The bar still forming at the end of a range reaching now is fetched again next time
+      const coverTo = Date.now() - params.granularity * 1000;
+      try {
+        await Promise.all(gaps.map(gap => this.sendFetchGap(gap, coverTo)));
+      } catch (error) {
+        this.logger.warn(`⚠️ Bar cache gap failed, fetching ${market}/${code} directly: ${error.message}`);
+        return null;
+      } finally {
+        gaps.forEach(gap => gap.delete());
+      }
+      
+      const queryInfo = {
+        type: 'fetchByCode',
+        market: market,
+        code: code,
+        qualifiedName: params.qualifiedName,
+        namespace: params.namespace,
+        granularity: params.granularity,
+        fromDate: params.fromDate,
+        toDate: params.toDate,
+        fields: params.fields,
+        revision: params.revision,
+        timestamp: Date.now()
+      };
+      const columns = this.barCache.read(request, params.fields);
+      const records = columns ? this.recordsFromColumns(columns, queryInfo) : [];
+      
+      this.emit('historical_data', { records, count: records.length });
+      return {
+        records: records,
+        count: records.length,
+        qualifiedName: params.qualifiedName,
+        market: market,
+        code: code,
+        success: true,
+        cached: gaps.length === 0
+      };
+    } finally {
+      request.delete();
+    }
+  }
+
+  /**
+   * Send one ATFetchByCodeReq planned by the bar cache; resolves once its bars
+   * are merged, rejects on a server error or after fetchGapTimeout ms
+   */
+  sendFetchGap(gap, coverTo) {
+    const currentSeqId = ++this.sequenceId;
+    
+    return new Promise((resolve, reject) => {
+      // Own handle: the planned gaps are deleted as soon as any of them fails
+      const request = gap.clone();
+      const timer = setTimeout(() => {
+        // A late response finds no query info and is dropped
+        this.queryCache.delete(currentSeqId);
+        request.delete();
+        reject(new Error(`Bar cache gap seq=${currentSeqId} timed out after ${this.fetchGapTimeout}ms`));
+      }, this.fetchGapTimeout);
+      this.queryCache.set(currentSeqId, {
+        type: 'barCacheGap',
+        request: request,
+        coverTo: coverTo,
+        timestamp: Date.now(),
+        resolve: (written) => {
+          clearTimeout(timer);
+          request.delete();
+          resolve(written);
+        },
+        reject: (error) => {
+          clearTimeout(timer);
+          request.delete();
+          reject(error);
+        }
+      });
+      
+      gap.token = this.token;
+      gap.seq = currentSeqId;
+      const pkg = new this.wasmModule.NetPackage();
+      const encodedMsg = pkg.encode(this.wasmModule.CMD_AT_FETCH_BY_CODE, gap.encode());
+      this.wsClient.sendBinary(Buffer.from(encodedMsg));
+      this.logger.info(`✅ ${this.getCommandName(this.wasmModule.CMD_AT_FETCH_BY_CODE)} sent for bar cache gap (seq=${currentSeqId})`);
+      pkg.delete();
+    });
+  }
+
   /**
    * Generic fetch by time range method - works with any metadata type  
    */
@@ -1748,10 +2278,81 @@ class CaitlynClientConnection {
       this.compressor.delete();
       this.compressor = null;
     }
+    if (this.frameDecoder) {
+      this.frameDecoder.delete();
+      this.frameDecoder = null;
+    }
+    if (this.snapshotStore) {
+      this.snapshotStore.delete();
+      this.snapshotStore = null;
+    }
+    if (this.securityMaster) {
+      this.securityMaster.delete();
+      this.securityMaster = null;
+    }
+    if (this.barCache) {
+      this.barCache.delete();
+      this.barCache = null;
+    }
+    if (this.decodePool) {
+      for (const waiter of this.decodeWaiters.values()) {
+        waiter.reject(new Error('Connection closed'));
+      }
+      this.decodeWaiters.clear();
+      this.decodePool.delete();
+      this.decodePool = null;
+    }
     
     this.logger.debug('✅ Disconnect process completed');
   }
 
+  /**
+   * Large payloads go to the decode pool; once something is queued every
+   * payload follows it, so responses keep their arrival order
+   */
+  usePoolDecode(pkg) {
+    return this.decodePool !== null &&
+      (pkg.length() >= this.poolDecodeThreshold || this.decodeWaiters.size > 0);
+  }
+
+  /**
+   * Decode a response payload on a DecodePool worker
+   * @param {number} kind - wasmModule.DECODE_FETCH or wasmModule.DECODE_SEEDS
+   * @param {Uint8Array} content - Response payload, copied before this returns
+   * @returns {Promise<Object>} ATFetchSVRes / ATUniverseSeedsRes, owned by the caller
+   */
+  decodeInPool(kind, content) {
+    return new Promise((resolve, reject) => {
+      // the pool listener runs in a later event-loop task, after the waiter is set
+      const ticket = this.decodePool.submit(kind, content);
+      this.decodeWaiters.set(ticket, { kind, resolve, reject });
+    });
+  }
+
+  /**
+   * Resolve finished decodes in submit order, run by the DecodePool listener
+   */
+  pumpDecodePool() {
+    if (!this.decodePool) {
+      return;
+    }
+    for (const ticket of this.decodePool.completed()) {
+      const waiter = this.decodeWaiters.get(ticket);
+      if (!waiter) {
+        continue;
+      }
+      this.decodeWaiters.delete(ticket);
+      const res = waiter.kind === this.wasmModule.DECODE_SEEDS
+        ? this.decodePool.takeSeeds(ticket)
+        : this.decodePool.takeFetch(ticket);
+      if (res) {
+        waiter.resolve(res);
+      } else {
+        waiter.reject(new Error(`Decode ticket ${ticket} returned no response`));
+      }
+    }
+  }
+
   /**
    * Subscribe to real-time data updates using ATSubscribeReq WASM command
    * @param {string|string[]} markets - Market code(s) (e.g., 'ICE' or ['ICE', 'DCE'])
@@ -1991,6 +2592,27 @@ class CaitlynClientConnection {
     return activeSubscriptions;
   }
 
+  /**
+   * Look up one security by market and code
+   * @returns {Object|null} {market, code, name, type, namespace, metaID}, null when unknown or without SecurityMaster
+   */
+  lookupSecurity(market, code) {
+    return this.securityMaster ? this.securityMaster.lookup(market, code) : null;
+  }
+
+  /**
+   * Securities whose code starts with prefix (case-insensitive), in code order
+   * @param {string} prefix - Code prefix
+   * @param {Object} options - {market: restrict to one market, limit: max results, 0 for all}
+   * @returns {Array} [{market, code, name, type, namespace, metaID}], empty without SecurityMaster
+   */
+  searchSecurities(prefix, options = {}) {
+    if (!this.securityMaster) {
+      return [];
+    }
+    return this.securityMaster.prefixSearch(prefix || '', options.market || '', options.limit || 0);
+  }
+
   /**
    * Get connection status
    */
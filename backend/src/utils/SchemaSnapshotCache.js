@@ -0,0 +1,113 @@
+/**
+ * SchemaSnapshotCache - Parse the schema once, share it everywhere
+ *
+ * The server sends the same schema definition to every connection. This cache
+ * keeps, per schema payload (SHA-1 of its bytes):
+ * - the binary IndexSchema snapshot (IndexSchema.saveSnapshot()), in memory and
+ *   optionally on disk, so later loads skip decompressing and parsing
+ * - the parsed IndexSchema per WASM module instance, so connections sharing a
+ *   module also share one parsed schema across their IndexSerializers
+ *
+ * Schemas handed out by acquire() are owned by the cache: callers must not
+ * delete() them. IndexSerializer.updateSchema() keeps its own reference.
+ */
+
+import crypto from 'crypto';
+import fs from 'fs';
+import path from 'path';
+
+export default class SchemaSnapshotCache {
+  /**
+   * @param {Object} options
+   * @param {string} options.directory - Directory for snapshot files, none to keep them in memory only
+   * @param {Object} options.logger - Logger
+   */
+  constructor(options = {}) {
+    this.directory = options.directory || null;
+    this.logger = options.logger || console;
+    this.snapshots = new Map(); // key -> Uint8Array snapshot
+    this.parsed = new Map();    // wasmModule -> {key, schema}
+  }
+
+  static keyOf(content) {
+    return crypto.createHash('sha1').update(content).digest('hex');
+  }
+
+  snapshotPath(key) {
+    return path.join(this.directory, `schema-${key}.bin`);
+  }
+
+  getSnapshot(key) {
+    if (this.snapshots.has(key)) {
+      return this.snapshots.get(key);
+    }
+    if (this.directory && fs.existsSync(this.snapshotPath(key))) {
+      const snapshot = fs.readFileSync(this.snapshotPath(key));
+      this.snapshots.set(key, snapshot);
+      return snapshot;
+    }
+    return null;
+  }
+
+  setSnapshot(key, snapshot) {
+    this.snapshots.set(key, snapshot);
+    if (this.directory) {
+      try {
+        fs.mkdirSync(this.directory, { recursive: true });
+        fs.writeFileSync(this.snapshotPath(key), snapshot);
+      } catch (error) {
+        this.logger.warn(`⚠️ Could not write schema snapshot: ${error.message}`);
+      }
+    }
+  }
+
+  /**
+   * Parsed IndexSchema for a schema payload
+   * @param {Object} wasmModule - Module the schema is used with
+   * @param {Uint8Array} content - Schema definition payload
+   * @returns {{schema: Object, source: string}} source is 'shared', 'snapshot' or 'parsed'
+   */
+  acquire(wasmModule, content) {
+    const key = SchemaSnapshotCache.keyOf(content);
+    const current = this.parsed.get(wasmModule);
+    if (current && current.key === key) {
+      return { schema: current.schema, source: 'shared' };
+    }
+
+    let schema = new wasmModule.IndexSchema();
+    let source = 'parsed';
+    const snapshot = typeof schema.loadSnapshot === 'function' ? this.getSnapshot(key) : null;
+    if (snapshot && schema.loadSnapshot(snapshot)) {
+      source = 'snapshot';
+    } else {
+      if (snapshot) {
+        // Stale or corrupt snapshot, start from a clean schema
+        schema.delete();
+        schema = new wasmModule.IndexSchema();
+      }
+      schema.load(content);
+      if (typeof schema.saveSnapshot === 'function') {
+        this.setSnapshot(key, schema.saveSnapshot());
+      }
+    }
+
+    // A new schema replaces the previous one of this module
+    if (current) {
+      current.schema.delete();
+    }
+    this.parsed.set(wasmModule, { key, schema });
+    return { schema, source };
+  }
+
+  /**
+   * Drop the parsed schemas of one module, or of every module
+   */
+  release(wasmModule = null) {
+    for (const [module, entry] of this.parsed) {
+      if (wasmModule === null || module === wasmModule) {
+        entry.schema.delete();
+        this.parsed.delete(module);
+      }
+    }
+  }
+}
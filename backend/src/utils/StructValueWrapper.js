@@ -41,6 +41,9 @@ export class SVObject {
         // Core StructValue instance
         this.sv = null;
         
+        // Field indices read by fromSv(), null reads all fields
+        this.projection = null;
+        
         // Metadata
         this.overwrite = true;
         this.persistent = true;
@@ -69,6 +72,7 @@ export class SVObject {
         
         // Convert IndexMeta to field definitions (equivalent to Python: index_meta_to_fields_def)
         this.fields = this.indexMetaToFieldsDef(meta);
+        this.projection = null;  // field indices may have changed
         this.buildFieldsSet();
     }
     
@@ -223,8 +227,10 @@ export class SVObject {
         this.code = sv.stockCode;
         this.granularity = sv.granularity;
         
-        // Extract field values by type
-        for (let i = 0; i < this.fields.length; i++) {
+        // Extract field values by type, only the projected ones when a projection is set
+        const count = this.projection ? this.projection.length : this.fields.length;
+        for (let k = 0; k < count; k++) {
+            const i = this.projection ? this.projection[k] : k;
             const [name, type] = this.fields[i];
             
             if (sv.isEmpty(i)) {
@@ -244,11 +250,14 @@ export class SVObject {
                 // Use getInt64() which returns string representation of int64
                 value = sv.getInt64(i);
             } else if (type.value === this.wasmModule.FieldType.IntegerVector.value) {
-                const vector = sv.getInt32Vector(i);
-                value = this.convertVectorToArray(vector);
+                // Array views copy in one pass instead of one embind call per element
+                value = sv.getInt32ArrayView
+                    ? Array.from(sv.getInt32ArrayView(i))
+                    : this.convertVectorToArray(sv.getInt32Vector(i));
             } else if (type.value === this.wasmModule.FieldType.DoubleVector.value) {
-                const vector = sv.getDoubleVector(i);
-                value = this.convertVectorToArray(vector);
+                value = sv.getDoubleArrayView
+                    ? Array.from(sv.getDoubleArrayView(i))
+                    : this.convertVectorToArray(sv.getDoubleVector(i));
             } else if (type.value === this.wasmModule.FieldType.StringVector.value) {
                 const vector = sv.getStringVector(i);
                 value = this.convertVectorToArray(vector);
@@ -261,6 +270,25 @@ export class SVObject {
         }
     }
     
+    /**
+     * Restrict fromSv()/toJSON() to a subset of fields
+     * Unknown names are ignored; pass null to read every field again
+     * @param {Array<string>|null} fieldNames - Field names to keep
+     */
+    setProjection(fieldNames) {
+        if (!Array.isArray(fieldNames)) {
+            this.projection = null;
+            return;
+        }
+        const wanted = new Set(fieldNames);
+        this.projection = [];
+        for (let i = 0; i < this.fields.length; i++) {
+            if (wanted.has(this.fields[i][0])) {
+                this.projection.push(i);
+            }
+        }
+    }
+    
     /**
      * Convert WASM Vector to JavaScript Array
      * @param {Object} vector - WASM Vector object (StringVector, Int32Vector, etc.)
@@ -342,7 +370,9 @@ export class SVObject {
             fields: {}
         };
         
-        for (const [name] of this.fields) {
+        const indices = this.projection || this.fields.map((_, i) => i);
+        for (const i of indices) {
+            const name = this.fields[i][0];
             result.fields[name] = this.getSvAttr(name);
         }
         
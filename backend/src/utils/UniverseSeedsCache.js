@@ -0,0 +1,139 @@
+/**
+ * UniverseSeedsCache - Skip seeds requests whose universe revision is unchanged
+ *
+ * Keeps the ATUniverseSeedsRes payloads of every (namespace, market,
+ * qualified name) with the revision they were fetched at, in a UniverseCache
+ * (docs/cxx/caitlyn_js_universe.hpp) per WASM module instance. The cache file
+ * is shared by all modules: in memory, and optionally on disk under directory,
+ * one file per server and token since private seeds differ per user. Native
+ * builds map the file instead of reading it (UniverseCache.loadFile()).
+ *
+ * Entries are tied to the schema the payloads were compressed with; a new
+ * schema key empties the cache.
+ */
+
+import crypto from 'crypto';
+import fs from 'fs';
+import path from 'path';
+
+export default class UniverseSeedsCache {
+  /**
+   * @param {Object} options
+   * @param {string} options.directory - Directory for cache files, none to keep them in memory only
+   * @param {Object} options.logger - Logger
+   */
+  constructor(options = {}) {
+    this.directory = options.directory || null;
+    this.logger = options.logger || console;
+    this.files = new Map();   // scope -> Uint8Array cache file
+    this.caches = new Map();  // wasmModule -> {scope, cache, dirty}
+  }
+
+  static scopeOf(url, token) {
+    return crypto.createHash('sha1').update(`${url}\n${token}`).digest('hex').substring(0, 16);
+  }
+
+  filePath(scope) {
+    return path.join(this.directory, `universe-${scope}.bin`);
+  }
+
+  /**
+   * UniverseCache of a module for a server and token, loaded from the last saved file
+   * @param {Object} wasmModule - Module the cache is used with
+   * @param {string} schemaKey - Key of the current schema (SchemaSnapshotCache.keyOf)
+   * @param {string} scope - UniverseSeedsCache.scopeOf(url, token)
+   * @returns {Object|null} UniverseCache owned by this object, null if the module has none
+   */
+  acquire(wasmModule, schemaKey, scope) {
+    if (typeof wasmModule.UniverseCache !== 'function') {
+      return null;
+    }
+    let entry = this.caches.get(wasmModule);
+    if (entry && entry.scope !== scope) {
+      entry.cache.delete();
+      entry = null;
+    }
+    if (!entry) {
+      entry = { scope, cache: new wasmModule.UniverseCache(), dirty: false };
+      this.caches.set(wasmModule, entry);
+      entry.cache.setSchemaKey(schemaKey);
+      const source = this.load(entry.cache, scope);
+      if (source) {
+        this.logger.info(`🌱 Universe cache loaded (${source}): ${entry.cache.size()} seeds, ${entry.cache.bytes()} bytes`);
+      }
+    } else {
+      entry.cache.setSchemaKey(schemaKey);
+    }
+    return entry.cache;
+  }
+
+  load(cache, scope) {
+    const file = this.files.get(scope);
+    if (file && cache.load(file)) {
+      return 'memory';
+    }
+    if (!this.directory || !fs.existsSync(this.filePath(scope))) {
+      return null;
+    }
+    if (typeof cache.loadFile === 'function') {
+      return cache.loadFile(this.filePath(scope)) ? 'mapped' : null;
+    }
+    const bytes = fs.readFileSync(this.filePath(scope));
+    if (cache.load(bytes)) {
+      this.files.set(scope, bytes);
+      return 'file';
+    }
+    return null;
+  }
+
+  /**
+   * Record the seeds payload fetched for a request
+   * @param {Object} request - {namespace, market, qualifiedName, revision, tradeDay}
+   * @param {Uint8Array} content - ATUniverseSeedsRes payload
+   */
+  store(wasmModule, request, content) {
+    const entry = this.caches.get(wasmModule);
+    if (!entry) {
+      return;
+    }
+    if (entry.cache.put(request.namespace, request.market, request.qualifiedName, request.revision, request.tradeDay, content)) {
+      entry.dirty = true;
+    }
+  }
+
+  /**
+   * Save the cache of a module after new seeds were stored
+   */
+  persist(wasmModule) {
+    const entry = this.caches.get(wasmModule);
+    if (!entry || !entry.dirty) {
+      return;
+    }
+    const file = entry.cache.save();
+    this.files.set(entry.scope, file);
+    entry.dirty = false;
+    if (this.directory) {
+      try {
+        fs.mkdirSync(this.directory, { recursive: true });
+        // write then rename, a mapped file is never rewritten in place
+        const target = this.filePath(entry.scope);
+        fs.writeFileSync(`${target}.tmp`, file);
+        fs.renameSync(`${target}.tmp`, target);
+      } catch (error) {
+        this.logger.warn(`⚠️ Could not write universe cache: ${error.message}`);
+      }
+    }
+  }
+
+  /**
+   * Drop the caches of one module, or of every module
+   */
+  release(wasmModule = null) {
+    for (const [module, entry] of this.caches) {
+      if (wasmModule === null || module === wasmModule) {
+        entry.cache.delete();
+        this.caches.delete(module);
+      }
+    }
+  }
+}
@@ -0,0 +1,135 @@
+/**
+ * Native Addon Parity Test
+ *
+ * Checks that public/caitlyn_node.node and public/caitlyn_js.wasm are
+ * interchangeable behind WasmService:
+ * 1. Both backends load and export the same classes (methods, properties and
+ *    base class), enums and enum values
+ * 2. Keepalive, universe, seeds and fetch-by-code requests encode to identical bytes
+ * 3. Frames encoded by one backend decode on the other to the same cmd/content
+ * 4. Optionally, a captured server frame (raw WebSocket message) decodes identically
+ *
+ * Usage: node test-native-parity.js [captured-frame.bin]
+ */
+
+import fs from 'fs';
+import WasmService from './src/services/WasmService.js';
+
+const bytes = (buffer) => new Uint8Array(buffer);
+
+// registered classes: constructors whose prototype chain ends in delete()/isAliasOf()
+const isBoundClass = (value) => typeof value === 'function' && typeof value.prototype?.isAliasOf === 'function';
+const isBoundEnum = (value) => value != null && typeof value.values === 'object' && !isBoundClass(value);
+const enumNames = (value) => Object.keys(value).filter(key => key !== 'values' && key !== 'argCount').sort().join(',');
+const members = (cls) => Object.getOwnPropertyNames(cls.prototype).filter(name => name !== 'constructor').sort();
+const baseName = (cls) => Object.getPrototypeOf(cls.prototype)?.constructor?.name;
+
+// differences between the exported classes and enums of two modules
+function apiDifferences(expected, actual) {
+    const differences = [];
+    for (const [name, value] of Object.entries(expected)) {
+        if (isBoundClass(value)) {
+            if (!isBoundClass(actual[name])) {
+                differences.push(`class ${name} missing`);
+                continue;
+            }
+            const have = new Set(members(actual[name]));
+            const missing = members(value).filter(member => !have.has(member));
+            if (missing.length > 0) {
+                differences.push(`${name} lacks ${missing.join(', ')}`);
+            }
+            if (baseName(value) !== 'ClassHandle' && baseName(value) !== baseName(actual[name])) {
+                differences.push(`${name} extends ${baseName(actual[name])} instead of ${baseName(value)}`);
+            }
+        } else if (isBoundEnum(value)) {
+            if (!isBoundEnum(actual[name]) || enumNames(value) !== enumNames(actual[name])) {
+                differences.push(`enum ${name} differs`);
+            }
+        }
+    }
+    return differences;
+}
+
+function sameBytes(a, b) {
+    a = bytes(a);
+    b = bytes(b);
+    if (a.length !== b.length) return false;
+    for (let i = 0; i < a.length; i++) {
+        if (a[i] !== b[i]) return false;
+    }
+    return true;
+}
+
+async function runParityTest() {
+    console.log('🧪 Native Addon Parity Test');
+    console.log('='.repeat(60));
+
+    const wasm = new WasmService({ backend: 'wasm' });
+    const native = new WasmService({ backend: 'native' });
+    await wasm.initialize();
+    await native.initialize();
+
+    if (native.getBackend() !== 'native') {
+        console.log('⚠️  public/caitlyn_node.node not found, nothing to compare');
+        return true;
+    }
+    console.log(`✅ Loaded backends: ${wasm.getBackend()} / ${native.getBackend()}`);
+
+    let failures = 0;
+    const check = (name, ok) => {
+        console.log(`${ok ? '✅' : '❌'} ${name}`);
+        if (!ok) failures++;
+    };
+
+    // Test 1: exported API
+    console.log('\n📚 Exported API');
+    const differences = apiDifferences(wasm.getModule(), native.getModule());
+    differences.slice(0, 20).forEach(difference => console.log(`   ${difference}`));
+    check('native addon exports every WASM class, member and enum', differences.length === 0);
+
+    // Test 2: request encoding
+    console.log('\n📤 Request encoding');
+    const token = 'parity-token';
+    const requests = {
+        keepalive: (s) => s.createKeepaliveMessage(),
+        universe: (s) => s.createUniverseRequest(token),
+        seeds: (s) => s.createUniverseSeedsRequest(token, 3, 1, 'global', 'Commodity', 'DCE', 0),
+        fetchByCode: (s) => s.createHistoricalDataByCodeRequest(token, 4, 'DCE', 'i<00>', 'SampleQuote', 0, 86400,
+            1700000000000, 1710000000000, ['open', 'close', 'volume'])
+    };
+    const encoded = {};
+    for (const [name, create] of Object.entries(requests)) {
+        encoded[name] = create(wasm);
+        check(`${name} request bytes match`, sameBytes(encoded[name], create(native)));
+    }
+
+    // Test 3: cross-backend decode
+    console.log('\n📥 Cross-backend decode');
+    for (const [name, frame] of Object.entries(encoded)) {
+        const a = wasm.decodeMessage(frame);
+        const b = native.decodeMessage(frame);
+        check(`${name} decodes to the same cmd/content`, a.cmd === b.cmd && sameBytes(a.content, b.content));
+    }
+
+    // Test 4: captured server frame
+    const capturePath = process.argv[2];
+    if (capturePath) {
+        console.log('\n📦 Captured frame');
+        const frame = fs.readFileSync(capturePath);
+        const a = wasm.decodeMessage(frame);
+        const b = native.decodeMessage(frame);
+        console.log(`   cmd=${wasm.getCommandName(a.cmd)}, content=${a.content.length} bytes`);
+        check('captured frame decodes to the same cmd/content', a.cmd === b.cmd && sameBytes(a.content, b.content));
+    }
+
+    wasm.cleanup();
+    native.cleanup();
+    console.log('\n' + '='.repeat(60));
+    console.log(failures === 0 ? '🎉 Backends are in parity' : `❌ ${failures} parity check(s) failed`);
+    return failures === 0;
+}
+
+runParityTest().then(ok => process.exit(ok ? 0 : 1)).catch(error => {
+    console.error('❌ Parity test failed:', error.message);
+    process.exit(1);
+});
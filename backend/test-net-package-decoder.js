@@ -0,0 +1,123 @@
+/**
+ * NetPackageDecoder Round-Trip Test
+ *
+ * Checks NetPackageDecoder against NetPackage.decode, the reference decoder:
+ * 1. Frames from NetPackage.encode decode to the same cmd and content bytes,
+ *    including empty and large contents and cmds with the high bit set
+ * 2. decodeFrames() on the same frames concatenated returns, per frame, the
+ *    cmd and an arena slice equal to NetPackage.decode; empty frames are
+ *    reported with length -1
+ *
+ * Usage: node test-net-package-decoder.js [wasm|native]
+ */
+
+import WasmService from './src/services/WasmService.js';
+
+const bytes = (buffer) => new Uint8Array(buffer);
+
+function sameBytes(a, b) {
+    a = bytes(a);
+    b = bytes(b);
+    if (a.length !== b.length) return false;
+    for (let i = 0; i < a.length; i++) {
+        if (a[i] !== b[i]) return false;
+    }
+    return true;
+}
+
+// cmd/content pairs covering empty, short, large and high-bit cmds
+const SAMPLES = [
+    [0x0102, 'ABCDEFGHIJKL'],
+    [0x0001, ''],
+    [0x7f01, 'x'],
+    [-0x7ffe, 'cmd with the high bit set'],
+    [0x0203, 'caitlyn '.repeat(8192)]
+];
+
+// copy of NetPackage.encode output, the result buffer is reused by the next encode
+function encode(module, cmd, content) {
+    const pkg = new module.NetPackage();
+    const frame = bytes(pkg.encode(cmd, content)).slice();
+    pkg.delete();
+    return frame;
+}
+
+// reference cmd and content through NetPackage.decode
+function reference(module, frame) {
+    const pkg = new module.NetPackage();
+    pkg.decode(frame);
+    const result = { cmd: pkg.header.cmd, content: bytes(pkg.content()).slice() };
+    pkg.delete();
+    return result;
+}
+
+async function runDecoderTest() {
+    console.log('🧪 NetPackageDecoder Round-Trip Test');
+    console.log('='.repeat(60));
+
+    const service = new WasmService({ backend: process.argv[2] || 'wasm' });
+    await service.initialize();
+    const module = service.getModule();
+    console.log(`✅ Loaded backend: ${service.getBackend()}`);
+
+    let failures = 0;
+    const check = (name, ok, detail = '') => {
+        console.log(`${ok ? '✅' : '❌'} ${name}${ok || !detail ? '' : ` (${detail})`}`);
+        if (!ok) failures++;
+    };
+
+    // Test 1: single frames
+    console.log('\n📦 decode()');
+    const decoder = new module.NetPackageDecoder();
+    for (const [cmd, content] of SAMPLES) {
+        const frame = encode(module, cmd, content);
+        const expected = reference(module, frame);
+        const decoded = decoder.decode(frame);
+        const name = `cmd 0x${(cmd & 0xffff).toString(16).padStart(4, '0')}, ${expected.content.length} byte(s)`;
+        check(name, decoded && decoder.header.cmd === expected.cmd && sameBytes(decoder.content(), expected.content),
+            `decoded ${decoded}, cmd ${decoder.header.cmd} vs ${expected.cmd}, ${decoder.length()} vs ${expected.content.length} byte(s)`);
+    }
+    check('empty frame is rejected', decoder.decode(new Uint8Array(0)) === false && decoder.length() === 0);
+
+    // Test 2: batched frames
+    console.log('\n📚 decodeFrames()');
+    const frames = SAMPLES.map(([cmd, content]) => encode(module, cmd, content));
+    const offsets = [];
+    let total = 0;
+    for (const frame of frames) {
+        offsets.push(total);
+        total += frame.length;
+    }
+    const buffer = new Uint8Array(total);
+    frames.forEach((frame, i) => buffer.set(frame, offsets[i]));
+
+    const table = decoder.decodeFrames(buffer, offsets).slice();
+    const arena = bytes(decoder.arena());
+    check('one (cmd, offset, length) entry per frame', table.length === frames.length * 3, `${table.length} entries`);
+    let packed = 0;
+    frames.forEach((frame, i) => {
+        const expected = reference(module, frame);
+        const [cmd, offset, length] = table.subarray(i * 3, i * 3 + 3);
+        check(`frame ${i}: cmd ${expected.cmd}, offset ${packed}, ${expected.content.length} byte(s)`,
+            cmd === expected.cmd && offset === packed && length === expected.content.length
+                && sameBytes(arena.subarray(offset, offset + length), expected.content),
+            `got cmd ${cmd}, offset ${offset}, length ${length}`);
+        packed += expected.content.length;
+    });
+
+    // repeated offset: an empty slot ahead of frame 0
+    const gap = decoder.decodeFrames(frames[0], [0, 0]).slice();
+    check('empty frame is reported with length -1', gap.length === 6 && gap[2] === -1 && gap[3] === 0x0102
+        && gap[5] === SAMPLES[0][1].length, `got ${Array.from(gap).join(', ')}`);
+
+    decoder.delete();
+    service.cleanup();
+    console.log('\n' + '='.repeat(60));
+    console.log(failures === 0 ? '🎉 NetPackageDecoder matches NetPackage' : `❌ ${failures} check(s) failed`);
+    return failures === 0;
+}
+
+runDecoderTest().then(ok => process.exit(ok ? 0 : 1)).catch(error => {
+    console.error('❌ NetPackageDecoder test failed:', error.message);
+    process.exit(1);
+});
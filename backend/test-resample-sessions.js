@@ -0,0 +1,212 @@
+/**
+ * Resample Session Test
+ *
+ * Checks the bar boundaries used by resample() against known trading sessions,
+ * through the ResampleClock of the loaded backend:
+ * 1. DCE iron ore (21:00-23:00, 09:00-10:15, 10:30-11:30, 13:30-15:00, UTC+8):
+ *    1-minute bars roll up to the expected 15m and 1h bars, none spanning a break
+ * 2. SHFE gold night session past midnight (21:00-02:30): bars keep counting
+ *    from 21:00 across the date change
+ * 3. Clock aligned daily bars honour the UTC offset
+ * 4. One configuration holding several products gives every code its own
+ *    sessions, as resample() looks them up per code
+ * 5. Optionally, resample() of a captured multi-code fetch response: every bar
+ *    starts where the clock of its own code puts it
+ *
+ * Time tags are bar starts (ms), as in resample() results.
+ *
+ * Usage: node test-resample-sessions.js [wasm|native] [schema-snapshot.bin fetch-frame.bin]
+ *   schema-snapshot.bin: IndexSchema.saveSnapshot() output, e.g. from SchemaSnapshotCache
+ *   fetch-frame.bin: raw WebSocket message of an ATFetchSVRes
+ */
+
+import fs from 'fs';
+import WasmService from './src/services/WasmService.js';
+
+const UTC_OFFSET = 8 * 3600;
+const MINUTE = 60 * 1000;
+// 2025-08-01 00:00 local (UTC+8)
+const DAY = Date.UTC(2025, 7, 1) - UTC_OFFSET * 1000;
+
+const at = (hhmm, day = DAY) => day + (Math.floor(hhmm / 100) * 60 + hhmm % 100) * MINUTE;
+const label = (ms) => {
+    const minutes = Math.floor((((ms - DAY) / MINUTE) % 1440 + 1440) % 1440);
+    return `${String(Math.floor(minutes / 60)).padStart(2, '0')}:${String(minutes % 60).padStart(2, '0')}`;
+};
+
+// 1-minute bar starts of HHMM sessions; sessions ending before they begin run past midnight
+function minuteBars(sessions, day = DAY) {
+    const bars = [];
+    for (const [begin, end] of sessions) {
+        const from = at(begin, day);
+        let to = at(end, day);
+        if (to <= from) to += 1440 * MINUTE;
+        for (let t = from; t < to; t += MINUTE) bars.push(t);
+    }
+    return bars;
+}
+
+// "HH:MM x rows" per target bar, in order of first appearance
+function rollUp(clock, bars) {
+    const buckets = new Map();
+    for (const t of bars) {
+        const bucket = clock.bucket(t);
+        buckets.set(bucket, (buckets.get(bucket) || 0) + 1);
+    }
+    return [...buckets].map(([bucket, rows]) => `${label(bucket)} x${rows}`);
+}
+
+// products: {product: [[HHMMSS begin, HHMMSS end], ...]}
+function samplerConfiguration(module, products) {
+    const config = new module.SamplerConfiguration();
+    const map = config.tradingPeriod;
+    for (const [product, periods] of Object.entries(products)) {
+        const vector = new module.Int32PairVector();
+        for (const [begin, end] of periods) {
+            const pair = new module.Int32Pair();
+            pair.first = begin;
+            pair.second = end;
+            vector.push_back(pair);
+            pair.delete();
+        }
+        map.set(product, vector);
+        vector.delete();
+    }
+    config.tradingPeriod = map;
+    map.delete();
+    return config;
+}
+
+// ATFetchSVRes of a captured frame, decoded against a schema snapshot
+function decodeFetch(module, schemaFile, frameFile) {
+    const schema = new module.IndexSchema();
+    if (!schema.loadSnapshot(fs.readFileSync(schemaFile))) {
+        schema.delete();
+        throw new Error(`${schemaFile} is not an IndexSchema snapshot`);
+    }
+    const compressor = new module.IndexSerializer();
+    compressor.updateSchema(schema);
+    const pkg = new module.NetPackage();
+    pkg.decode(fs.readFileSync(frameFile));
+    const res = new module.ATFetchSVRes();
+    res.setCompressor(compressor);
+    res.decode(pkg.content());
+    [pkg, compressor, schema].forEach(handle => handle.delete());
+    return res;
+}
+
+async function runResampleTest() {
+    console.log('🧪 Resample Session Test');
+    console.log('='.repeat(60));
+
+    const service = new WasmService({ backend: process.argv[2] || 'wasm' });
+    await service.initialize();
+    const module = service.getModule();
+    console.log(`✅ Loaded backend: ${service.getBackend()}`);
+
+    let failures = 0;
+    const check = (name, actual, expected) => {
+        const ok = actual.join(', ') === expected.join(', ');
+        console.log(`${ok ? '✅' : '❌'} ${name}`);
+        if (!ok) {
+            console.log(`   expected: ${expected.join(', ')}`);
+            console.log(`   actual:   ${actual.join(', ')}`);
+            failures++;
+        }
+    };
+
+    // Test 1: DCE iron ore
+    console.log('\n⛏️  DCE i<00>');
+    const dceSessions = [[2100, 2300], [900, 1015], [1030, 1130], [1330, 1500]];
+    const dcePeriods = [[210000, 230000], [90000, 101500], [103000, 113000], [133000, 150000]];
+    const dce = samplerConfiguration(module, { i: dcePeriods });
+    const dceBars = minuteBars(dceSessions);
+
+    const hourly = new module.ResampleClock(3600, UTC_OFFSET);
+    hourly.setSessions(dce, 'i<00>');
+    check('1h bars restart at every session', rollUp(hourly, dceBars), [
+        '21:00 x60', '22:00 x60',
+        '09:00 x60', '10:00 x15',
+        '10:30 x60',
+        '13:30 x60', '14:30 x30'
+    ]);
+
+    const quarter = new module.ResampleClock(900, UTC_OFFSET);
+    quarter.setSessions(dce, 'i<00>');
+    const quarters = rollUp(quarter, dceBars);
+    check('15m bars fill every session exactly', [quarters.length, quarters.every(bar => bar.endsWith('x15'))],
+        [(120 + 75 + 60 + 90) / 15, true]);
+    check('bar starting at a session end falls back to the clock', [label(hourly.bucket(at(1015)))], ['10:00']);
+
+    // Test 2: SHFE gold night session
+    console.log('\n🌙 SHFE au<00>');
+    const shfePeriods = [[210000, 23000]];
+    const shfe = samplerConfiguration(module, { au: shfePeriods });
+    const night = new module.ResampleClock(3 * 3600, UTC_OFFSET);
+    night.setSessions(shfe, 'au<00>');
+    check('3h bars run from 21:00 across midnight', rollUp(night, minuteBars([[2100, 230]])), [
+        '21:00 x180', '00:00 x150'
+    ]);
+
+    // Test 3: clock aligned daily bars
+    console.log('\n🕛 Clock aligned');
+    const daily = new module.ResampleClock(86400, UTC_OFFSET);
+    check('daily bars start at local midnight', [
+        label(daily.bucket(at(0))), label(daily.bucket(at(2359))), daily.bucket(at(2359)) === DAY
+    ], ['00:00', '00:00', true]);
+    const utc = new module.ResampleClock(86400, 0);
+    check('without an offset daily bars start at UTC midnight', [utc.bucket(at(900)) === Date.UTC(2025, 7, 1)], [true]);
+
+    // Test 4: one configuration, several products
+    console.log('\n🔀 Per code sessions');
+    const both = samplerConfiguration(module, { i: dcePeriods, au: shfePeriods });
+    const ironOre = new module.ResampleClock(3600, UTC_OFFSET);
+    ironOre.setSessions(both, 'i<00>');
+    const gold = new module.ResampleClock(3600, UTC_OFFSET);
+    gold.setSessions(both, 'au<00>');
+    check('each code gets the sessions of its own product', [
+        label(ironOre.bucket(at(2230))), label(gold.bucket(at(2230))),
+        label(ironOre.bucket(at(1045))), label(gold.bucket(at(1045)))
+    ], ['22:00', '22:00', '10:30', '10:00']);
+    check('a code of another product keeps its own sessions', [
+        rollUp(ironOre, minuteBars([[900, 1015]])).join(' '), rollUp(gold, minuteBars([[2100, 230]])).join(' ')
+    ], ['09:00 x60 10:00 x15', '21:00 x60 22:00 x60 23:00 x60 00:00 x60 01:00 x60 02:00 x30']);
+
+    // Test 5: captured fetch response
+    if (process.argv[4]) {
+        console.log('\n📼 Captured fetch response');
+        const res = decodeFetch(module, process.argv[3], process.argv[4]);
+        const bars = module.resample(res, 3600, both, UTC_OFFSET);
+        if (!bars) {
+            check('meta of the response is in the schema', [false], [true]);
+        } else {
+            const clocks = bars.codeDict.map(code => {
+                const clock = new module.ResampleClock(3600, UTC_OFFSET);
+                clock.setSessions(both, code);
+                return clock;
+            });
+            const misplaced = [];
+            for (let i = 0; i < bars.count; i++) {
+                const start = Number(bars.timeTags[i]);
+                if (clocks[bars.codes[i]].bucket(start) !== start) {
+                    misplaced.push(`${bars.codeDict[bars.codes[i]]}@${label(start)}`);
+                }
+            }
+            console.log(`   ${bars.count} bars over ${bars.codeDict.length} code(s)`);
+            check('bars start on the sessions of their own code', misplaced.slice(0, 5), []);
+            clocks.forEach(clock => clock.delete());
+        }
+        res.delete();
+    }
+
+    [hourly, quarter, night, daily, utc, ironOre, gold, dce, shfe, both].forEach(handle => handle.delete());
+    service.cleanup();
+    console.log('\n' + '='.repeat(60));
+    console.log(failures === 0 ? '🎉 Session boundaries match' : `❌ ${failures} check(s) failed`);
+    return failures === 0;
+}
+
+runResampleTest().then(ok => process.exit(ok ? 0 : 1)).catch(error => {
+    console.error('❌ Resample test failed:', error.message);
+    process.exit(1);
+});
@@ -6,7 +6,11 @@
 #include <utils/time.hpp>
 #include <precompile/types.hpp>
 #include <string>
+#include <cstring>
+#include <algorithm>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 #include <emscripten/bind.h>
 #include <protocol/caitlyn_tm_protocol_entity.hpp>
 #include <protocol/caitlyn_tm_comm_protocol.hpp>
@@ -15,6 +19,20 @@
 
 #include <caitlyn_js_types.hpp>
 #include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_schema.hpp>
+#include <caitlyn_js_universe.hpp>
+#include <caitlyn_js_simd.hpp>
+#include <caitlyn_js_meta.hpp>
+#include <caitlyn_js_columns.hpp>
+#include <caitlyn_js_resample.hpp>
+#include <caitlyn_js_bars.hpp>
+#include <caitlyn_js_indicators.hpp>
+#include <caitlyn_js_formula.hpp>
+#include <caitlyn_js_security.hpp>
+#include <caitlyn_js_json.hpp>
+#include <caitlyn_js_snapshot.hpp>
+#include <caitlyn_js_delta.hpp>
+#include <caitlyn_js_pool.hpp>
 
 using namespace emscripten;
 using namespace raisethink::caitlyn::net::commandType;
@@ -44,7 +62,24 @@ int main(int argc, char**argv) {
     // req.encode_binary(data);
     return 0;
 }
-ByteArray __encode_buffer;
+
+// uncompressed frames carry an 8 byte route prefix ahead of the package header
+const size_t __NET_FRAME_PREFIX = 8;
+// package header on the wire: 8 bytes ending with cmd as a big-endian int16,
+// content follows
+const size_t __NET_HEADER_SIZE = 8;
+const size_t __NET_HEADER_CMD = 6;
+
+// reads the wire header field by field, as _net_package::decode does; the
+// in-memory _net_header layout and byte order differ from the wire
+inline void __decode_net_header(const uint8_t* data, _net_header& header) {
+    header = _net_header();
+    header.cmd = (int16_t)(((uint16_t)data[__NET_HEADER_CMD] << 8) | data[__NET_HEADER_CMD + 1]);
+}
+
+// NetPackage.encode() result, overwritten by the next encode on the same thread.
+// Use NetPackageEncoder when several encoded requests must stay alive.
+thread_local ByteArray __encode_buffer;
 
 val _encode_package(
     _net_package& pkg, 
@@ -60,12 +95,80 @@ val _encode_package(
     raisethink::caitlyn::serializer::compress(__buf, __encode_buffer);
     return val(typed_memory_view(__encode_buffer.size(), &__encode_buffer[0]));
 }
+
+/*
+ * Outbound encoder owning a ring of output buffers.
+ * encode() compresses into the next free slot and returns {slot, data}; the
+ * slot keeps its bytes until release(slot), so requests can be encoded back
+ * to back and sent later. When every slot is held the ring grows by one.
+ * Moving a ByteArray keeps its storage, so growth never relocates a held slot,
+ * but WASM memory growth still detaches JS views: use view(slot) to re-acquire.
+ */
+class _net_package_encoder {
+public:
+    _net_package_encoder():m_ring(4), m_busy(4, false), m_next(0) {}
+    _net_package_encoder(size_t slots):m_ring(slots ? slots : 1), m_busy(slots ? slots : 1, false), m_next(0) {}
+
+    val encode(int16_t cmd, const std::string &content) {
+        size_t __slot = acquire();
+        m_pkg.m_pkgHeader.cmd = cmd;
+        m_pkg.m_pkgContent.resize(content.size());
+        std::copy(content.begin(), content.end(), m_pkg.m_pkgContent.begin());
+        m_scratch.clear();
+        m_pkg.encode(m_scratch);
+        m_ring[__slot].clear();
+        raisethink::caitlyn::serializer::compress(m_scratch, m_ring[__slot]);
+
+        val __ret = val::object();
+        __ret.set("slot", (int32_t)__slot);
+        __ret.set("data", view(__slot));
+        return __ret;
+    }
+    val view(int32_t slot) {
+        if(slot < 0 || (size_t)slot >= m_ring.size() || !m_busy[slot] || m_ring[slot].empty()){
+            return val::null();
+        }
+        return val(typed_memory_view(m_ring[slot].size(), &m_ring[slot][0]));
+    }
+    void release(int32_t slot) {
+        if(slot >= 0 && (size_t)slot < m_busy.size()){
+            m_busy[slot] = false;
+        }
+    }
+    size_t slots() const {
+        return m_ring.size();
+    }
+    size_t in_use() const {
+        return std::count(m_busy.begin(), m_busy.end(), true);
+    }
+private:
+    size_t acquire() {
+        for(size_t i = 0; i < m_ring.size(); i++){
+            size_t __slot = (m_next + i) % m_ring.size();
+            if(!m_busy[__slot]){
+                m_busy[__slot] = true;
+                m_next = (__slot + 1) % m_ring.size();
+                return __slot;
+            }
+        }
+        m_ring.push_back(ByteArray());
+        m_busy.push_back(true);
+        m_next = 0;
+        return m_ring.size() - 1;
+    }
+
+    _net_package m_pkg;
+    ByteArray m_scratch;
+    std::vector<ByteArray> m_ring;
+    std::vector<bool> m_busy;
+    size_t m_next;
+};
 void _decode_package(_net_package& pkg, const std::string &data) {
     ByteArray __buf;
     if(data.size()>0){
         raisethink::caitlyn::serializer::uncompress((uint8_t*)&data[0], data.size(), __buf);
         // printf("OK %lu %lu\n", data.size(), __buf.size());
-        pkg.decode((uint8_t*)&__buf[8], __buf.size()-8);
+        pkg.decode((uint8_t*)&__buf[__NET_FRAME_PREFIX], __buf.size()-__NET_FRAME_PREFIX);
     }
 }
 val _package_content(_net_package&pkg){
@@ -79,14 +182,339 @@ size_t _package_length(_net_package&pkg) {
     return pkg.m_pkgContent.size();
 }
 
+/*
+ * Reusable inbound frame decoder.
+ * The frame is uncompressed into m_arena, which keeps its capacity between
+ * frames, and content() views the payload in place instead of copying it
+ * into a _net_package. The header is read in wire order, the same way
+ * _net_package::decode does. The view is only valid until the next decode().
+ */
+class _net_package_decoder {
+public:
+    _net_package_decoder():m_offset(0), m_length(0) {}
+
+    bool decode(const std::string &data) {
+        m_arena.clear();
+        m_header = _net_header();
+        m_offset = m_length = 0;
+        if(data.empty()){
+            return false;
+        }
+        raisethink::caitlyn::serializer::uncompress((uint8_t*)&data[0], data.size(), m_arena);
+        if(m_arena.size() < __NET_FRAME_PREFIX + __NET_HEADER_SIZE){
+            m_arena.clear();
+            return false;
+        }
+        __decode_net_header(&m_arena[__NET_FRAME_PREFIX], m_header);
+        m_offset = __NET_FRAME_PREFIX + __NET_HEADER_SIZE;
+        m_length = m_arena.size() - m_offset;
+        return true;
+    }
+    val content() {
+        return val(typed_memory_view(m_length, m_length ? &m_arena[m_offset] : (uint8_t*)0));
+    }
+    size_t length() const {
+        return m_length;
+    }
+    size_t capacity() const {
+        return m_arena.capacity();
+    }
+    /*
+     * Decodes a batch of concatenated frames in one call. offsets holds the
+     * start of every frame in buffer; a frame ends where the next one starts.
+     * Contents are packed back to back into the arena and the returned
+     * Int32Array holds one (cmd, content offset, content length) triple per
+     * frame, offsets relative to arena(). Frames too short to carry a header
+     * are reported with length -1. Both views are valid until the next decode.
+     */
+    val decode_frames(const std::string &buffer, val offsets) {
+        std::vector<uint32_t> __offsets = convertJSArrayToNumberVector<uint32_t>(offsets);
+        m_arena.clear();
+        m_frames.clear();
+        m_header = _net_header();
+        m_offset = m_length = 0;
+        m_frames.reserve(__offsets.size() * 3);
+        for(size_t i = 0; i < __offsets.size(); i++){
+            size_t __begin = __offsets[i];
+            size_t __end = i + 1 < __offsets.size() ? __offsets[i + 1] : buffer.size();
+            _net_header __header = _net_header();
+            m_scratch.clear();
+            if(__begin < __end && __end <= buffer.size()){
+                raisethink::caitlyn::serializer::uncompress((uint8_t*)&buffer[__begin], __end - __begin, m_scratch);
+            }
+            if(m_scratch.size() < __NET_FRAME_PREFIX + __NET_HEADER_SIZE){
+                m_frames.push_back(__header.cmd);
+                m_frames.push_back((int32_t)m_arena.size());
+                m_frames.push_back(-1);
+                continue;
+            }
+            __decode_net_header(&m_scratch[__NET_FRAME_PREFIX], __header);
+            size_t __content = __NET_FRAME_PREFIX + __NET_HEADER_SIZE;
+            m_frames.push_back(__header.cmd);
+            m_frames.push_back((int32_t)m_arena.size());
+            m_frames.push_back((int32_t)(m_scratch.size() - __content));
+            m_arena.insert(m_arena.end(), m_scratch.begin() + __content, m_scratch.end());
+        }
+        return val(typed_memory_view(m_frames.size(), m_frames.empty() ? (int32_t*)0 : &m_frames[0]));
+    }
+    val arena() {
+        return val(typed_memory_view(m_arena.size(), m_arena.empty() ? (uint8_t*)0 : &m_arena[0]));
+    }
+    // drop the arena after an unusually large frame
+    void shrink() {
+        ByteArray().swap(m_arena);
+        ByteArray().swap(m_scratch);
+        std::vector<int32_t>().swap(m_frames);
+        m_offset = m_length = 0;
+    }
 
+    _net_header m_header;
+private:
+    ByteArray m_arena;
+    ByteArray m_scratch;
+    std::vector<int32_t> m_frames;
+    size_t m_offset;
+    size_t m_length;
+};
+
+
+// serializers reference the registry's schema, later schemas are merged into it
 void _update_schema(_index_serializer& compressor, boost::shared_ptr<_index_schema> schema){
-    compressor.update_schema(schema);
+    compressor.update_schema(_meta_directory::instance().load(schema));
+}
+
+// IndexSerializer.applySchemaDelta(metas): metas of a newer definition, e.g. IndexSchema.metas();
+// the serializer is pointed at the merged schema even when another one applied the delta first
+size_t _apply_schema_delta(_index_serializer& compressor, const std::vector<_index_meta>& metas){
+    size_t __applied = _meta_directory::instance().apply_delta(metas);
+    boost::shared_ptr<_index_schema> __schema = _meta_directory::instance().image()->schema;
+    if(__schema){
+        compressor.update_schema(__schema);
+    }
+    return __applied;
+}
+
+// the registry's current schema, e.g. for DecodePool.setSchema() after a delta
+boost::shared_ptr<_index_schema> _current_schema(_index_serializer& compressor){
+    return _meta_directory::instance().image()->schema;
+}
+
+// generation of the schema image currently published, bumped by every schema change
+double _schema_tag(_index_serializer& compressor){
+    return (double)_meta_directory::instance().tag();
+}
+
+// IndexSchema.saveSnapshot(): a copy, safe to keep, share or write to disk
+val _save_index_schema_snapshot(_index_schema& schema){
+    ByteArray __buf;
+    _save_schema_snapshot(schema, __buf);
+    val __ret = val::global("Uint8Array").new_(__buf.size());
+    __ret.call<void>("set", val(typed_memory_view(__buf.size(), &__buf[0])));
+    return __ret;
+}
+
+// the Uint8Array to std::string conversion is the only copy into WASM memory
+bool _load_index_schema_snapshot(_index_schema& schema, const std::string& data){
+    return _load_schema_snapshot(schema, (const uint8_t*)data.data(), data.size());
+}
+
+// UniverseCache.load(bytes): the cache keeps the copy its entries point into
+bool _universe_cache_load(_universe_cache& cache, std::string data){
+    boost::shared_ptr<const std::string> __data = boost::make_shared<const std::string>(std::move(data));
+    return cache.load((const uint8_t*)__data->data(), __data->size(), __data);
+}
+
+// UniverseCache.save(): a copy, safe to write to disk
+val _universe_cache_save(const _universe_cache& cache){
+    ByteArray __buf;
+    cache.save(__buf);
+    val __ret = val::global("Uint8Array").new_(__buf.size());
+    __ret.call<void>("set", val(typed_memory_view(__buf.size(), &__buf[0])));
+    return __ret;
+}
+
+// UniverseCache.seeds(ns, market, qualifiedName): view for ATUniverseSeedsRes.decode(), null when absent
+val _universe_cache_seeds(const _universe_cache& cache, const std::string& ns, const std::string& market, const std::string& qualified_name){
+    const _universe_seeds* __seeds = cache.find(ns, market, qualified_name);
+    return __seeds ? val(typed_memory_view(__seeds->size, __seeds->data)) : val::null();
+}
+
+// UniverseCache.revision(ns, market, qualifiedName): cached revision, null when absent
+val _universe_cache_revision(const _universe_cache& cache, const std::string& ns, const std::string& market, const std::string& qualified_name){
+    const _universe_seeds* __seeds = cache.find(ns, market, qualified_name);
+    return __seeds ? val(__seeds->revision) : val::null();
+}
+
+/*
+ * StructValue.getDoubleArrayView(i) and friends: typed array views over the
+ * vector stored in the StructValue, no copy. A view is valid while the
+ * StructValue is alive and field i is not set again, and only until WASM
+ * memory grows, which any later allocating call may trigger. Keep values
+ * with view.slice() or copyDoubleVectorInto(). Views are null, and copies
+ * copy nothing, for an index out of range or an empty field.
+ */
+template<typename R, typename T>
+struct __is_stored_vector : std::integral_constant<bool,
+    std::is_reference<R>::value && std::is_same<typename std::decay<R>::type, std::vector<T> >::value> {};
+static_assert(__is_stored_vector<decltype(std::declval<_sv&>().getDoubleVector(0)), double>::value,
+    "array views need getDoubleVector() to return a reference to the stored vector");
+static_assert(__is_stored_vector<decltype(std::declval<_sv&>().getInt32Vector(0)), int32_t>::value,
+    "array views need getInt32Vector() to return a reference to the stored vector");
+static_assert(__is_stored_vector<decltype(std::declval<_sv&>().getInt64Vector(0)), int64_t>::value,
+    "array views need getInt64Vector() to return a reference to the stored vector");
+
+bool __sv_has_vector(_sv& sv, int32_t i){
+    return i >= 0 && i < (int32_t)sv.size() && !sv.isEmpty(i);
+}
+template<typename T>
+val __vector_view(const std::vector<T>& v){
+    return val(typed_memory_view(v.size(), v.data()));
+}
+val _sv_double_array_view(_sv& sv, int32_t i){
+    return __sv_has_vector(sv, i) ? __vector_view(sv.getDoubleVector(i)) : val::null();
+}
+val _sv_int32_array_view(_sv& sv, int32_t i){
+    return __sv_has_vector(sv, i) ? __vector_view(sv.getInt32Vector(i)) : val::null();
+}
+// BigInt64Array
+val _sv_int64_array_view(_sv& sv, int32_t i){
+    return __sv_has_vector(sv, i) ? __vector_view(sv.getInt64Vector(i)) : val::null();
+}
+
+// copies field i into a caller owned typed array, returns the number of values copied
+template<typename T>
+size_t __copy_vector_into(const std::vector<T>& v, val target){
+    size_t __n = std::min(v.size(), target["length"].as<size_t>());
+    if(__n){
+        target.call<void>("set", val(typed_memory_view(__n, v.data())));
+    }
+    return __n;
+}
+size_t _sv_copy_double_vector_into(_sv& sv, int32_t i, val target){
+    return __sv_has_vector(sv, i) ? __copy_vector_into(sv.getDoubleVector(i), target) : 0;
+}
+size_t _sv_copy_int32_vector_into(_sv& sv, int32_t i, val target){
+    return __sv_has_vector(sv, i) ? __copy_vector_into(sv.getInt32Vector(i), target) : 0;
+}
+// BigInt64Array target
+size_t _sv_copy_int64_vector_into(_sv& sv, int32_t i, val target){
+    return __sv_has_vector(sv, i) ? __copy_vector_into(sv.getInt64Vector(i), target) : 0;
+}
+
+// number of compiled decode plans, one per loaded (namespace, ID, revision)
+size_t _plan_count(_index_serializer& compressor){
+    return _meta_directory::instance().plan_count();
+}
+
+// fixed point Int32Array to Float64Array, e.g. scale = 1 / multiple
+val _scale_int32(val values, double scale){
+    std::vector<int32_t> __in = convertJSArrayToNumberVector<int32_t>(values);
+    std::vector<double> __out(__in.size());
+    if(!__in.empty()){
+        __i32_to_f64_scaled(&__in[0], &__out[0], __in.size(), scale);
+    }
+    return __to_typed_array(__out, "Float64Array");
 }
 
 EMSCRIPTEN_BINDINGS(test) {
     function("mypi", &mypi);
     function("version", &version);
+    function("simdEnabled", &_simd_enabled);
+    function("scaleInt32", &_scale_int32);
+
+    function("sma", &_indicator_sma);
+    function("ema", &_indicator_ema);
+    function("wma", &_indicator_wma);
+    function("rsi", &_indicator_rsi);
+    function("macd", &_indicator_macd);
+    function("bollinger", &_indicator_bollinger);
+    function("atr", &_indicator_atr);
+    function("vwap", &_indicator_vwap);
+    function("rollingStd", &_indicator_rolling_std);
+    function("rollingMin", &_indicator_rolling_min);
+    function("rollingMax", &_indicator_rolling_max);
+    class_<_sma_indicator>("SMAIndicator")
+        .constructor<int32_t>()
+        .function("update", &_sma_indicator::update)
+        .function("value", &_sma_indicator::value)
+        .function("ready", &_sma_indicator::ready)
+        .function("reset", &_sma_indicator::reset)
+    ;
+    class_<_ema_indicator>("EMAIndicator")
+        .constructor<int32_t>()
+        .function("update", &_ema_indicator::update)
+        .function("value", &_ema_indicator::value)
+        .function("ready", &_ema_indicator::ready)
+        .function("reset", &_ema_indicator::reset)
+    ;
+    class_<_wma_indicator>("WMAIndicator")
+        .constructor<int32_t>()
+        .function("update", &_wma_indicator::update)
+        .function("value", &_wma_indicator::value)
+        .function("ready", &_wma_indicator::ready)
+        .function("reset", &_wma_indicator::reset)
+    ;
+    class_<_rsi_indicator>("RSIIndicator")
+        .constructor<int32_t>()
+        .function("update", &_rsi_indicator::update)
+        .function("value", &_rsi_indicator::value)
+        .function("ready", &_rsi_indicator::ready)
+        .function("reset", &_rsi_indicator::reset)
+    ;
+    class_<_macd_indicator>("MACDIndicator")
+        .constructor<int32_t, int32_t, int32_t>()
+        .function("update", &_macd_indicator::update)
+        .function("macd", &_macd_indicator::macd)
+        .function("signal", &_macd_indicator::signal)
+        .function("histogram", &_macd_indicator::histogram)
+        .function("ready", &_macd_indicator::ready)
+        .function("reset", &_macd_indicator::reset)
+    ;
+    class_<_bollinger_indicator>("BollingerIndicator")
+        .constructor<int32_t, double>()
+        .function("update", &_bollinger_indicator::update)
+        .function("middle", &_bollinger_indicator::middle)
+        .function("upper", &_bollinger_indicator::upper)
+        .function("lower", &_bollinger_indicator::lower)
+        .function("deviation", &_bollinger_indicator::deviation)
+        .function("ready", &_bollinger_indicator::ready)
+        .function("reset", &_bollinger_indicator::reset)
+    ;
+    class_<_atr_indicator>("ATRIndicator")
+        .constructor<int32_t>()
+        .function("update", &_atr_indicator::update)
+        .function("value", &_atr_indicator::value)
+        .function("ready", &_atr_indicator::ready)
+        .function("reset", &_atr_indicator::reset)
+    ;
+    class_<_vwap_indicator>("VWAPIndicator")
+        .constructor<>()
+        .function("update", &_vwap_indicator::update)
+        .function("value", &_vwap_indicator::value)
+        .function("ready", &_vwap_indicator::ready)
+        .function("reset", &_vwap_indicator::reset)
+    ;
+    class_<_rolling_std_indicator>("RollingStdIndicator")
+        .constructor<int32_t>()
+        .function("update", &_rolling_std_indicator::update)
+        .function("value", &_rolling_std_indicator::value)
+        .function("ready", &_rolling_std_indicator::ready)
+        .function("reset", &_rolling_std_indicator::reset)
+    ;
+    class_<_rolling_min_indicator>("RollingMinIndicator")
+        .constructor<int32_t>()
+        .function("update", &_rolling_min_indicator::update)
+        .function("value", &_rolling_min_indicator::value)
+        .function("ready", &_rolling_min_indicator::ready)
+        .function("reset", &_rolling_min_indicator::reset)
+    ;
+    class_<_rolling_max_indicator>("RollingMaxIndicator")
+        .constructor<int32_t>()
+        .function("update", &_rolling_max_indicator::update)
+        .function("value", &_rolling_max_indicator::value)
+        .function("ready", &_rolling_max_indicator::ready)
+        .function("reset", &_rolling_max_indicator::reset)
+    ;
     
 
     constant("NET_CMD_GOLD_ROUTE_KEEPALIVE",NET_CMD_GOLD_ROUTE_KEEPALIVE);
@@ -201,7 +629,27 @@ EMSCRIPTEN_BINDINGS(test) {
         .function("encode", &_encode_package)
         .function("decode", &_decode_package)
     ;
-    
+    class_<_net_package_encoder>("NetPackageEncoder")
+        .constructor<>()
+        .constructor<size_t>()
+        .function("encode", &_net_package_encoder::encode)
+        .function("view", &_net_package_encoder::view)
+        .function("release", &_net_package_encoder::release)
+        .function("slots", &_net_package_encoder::slots)
+        .function("inUse", &_net_package_encoder::in_use)
+    ;
+    class_<_net_package_decoder>("NetPackageDecoder")
+        .constructor<>()
+        .property("header", &_net_package_decoder::m_header)
+        .function("decode", &_net_package_decoder::decode)
+        .function("content", &_net_package_decoder::content)
+        .function("length", &_net_package_decoder::length)
+        .function("capacity", &_net_package_decoder::capacity)
+        .function("decodeFrames", &_net_package_decoder::decode_frames)
+        .function("arena", &_net_package_decoder::arena)
+        .function("shrink", &_net_package_decoder::shrink)
+    ;
+
     constant("NAMESPACE_GLOBAL", 0);
     constant("NAMESPACE_PRIVATE", 1);
 
@@ -231,6 +679,13 @@ EMSCRIPTEN_BINDINGS(test) {
         .function("setStringVector", &_sv::setStringVector)
         .function("getDoubleVector", &_sv::getDoubleVector)
         .function("setDoubleVector", &_sv::setDoubleVector)
+        .function("getDoubleArrayView", &_sv_double_array_view)
+        .function("getInt32ArrayView", &_sv_int32_array_view)
+        .function("getInt64ArrayView", &_sv_int64_array_view)
+        .function("copyDoubleVectorInto", &_sv_copy_double_vector_into)
+        .function("copyInt32VectorInto", &_sv_copy_int32_vector_into)
+        .function("copyInt64VectorInto", &_sv_copy_int64_vector_into)
+        .function("toObject", &_sv_to_object)
         .function("isEmpty", &_sv::isEmpty)
         .function("reset", &_sv::reset)
         ;
@@ -284,6 +739,8 @@ EMSCRIPTEN_BINDINGS(test) {
         .smart_ptr_constructor("IndexSchema", &boost::make_shared<_index_schema>)
         .function("load", &_load_index_schema_from_string)
         .function("load_old_version", &_load_index_schema_from_string_old_version)
+        .function("saveSnapshot", &_save_index_schema_snapshot)
+        .function("loadSnapshot", &_load_index_schema_snapshot)
         // .function("save", &_index_schema::save)
         .function("metas", &_get_index_schema_metas)
         ;
@@ -291,6 +748,10 @@ EMSCRIPTEN_BINDINGS(test) {
         .smart_ptr_constructor("IndexSerializer", &boost::make_shared<_index_serializer>)
         .function("deserializeByTime", &_deserialize_by_time)
         .function("updateSchema", &_update_schema)
+        .function("planCount", &_plan_count)
+        .function("schemaTag", &_schema_tag)
+        .function("applySchemaDelta", &_apply_schema_delta)
+        .function("currentSchema", &_current_schema)
         ;
             
     class_<_base_request>("ATBaseRequest")
@@ -347,11 +808,38 @@ EMSCRIPTEN_BINDINGS(test) {
     class_<_at_universe_seeds_res, base<_base_response>>("ATUniverseSeedsRes")
         .constructor<>()
         .constructor<int32_t, const std::string&>()
+        .smart_ptr<boost::shared_ptr<_at_universe_seeds_res>>("ATUniverseSeedsRes")
         .function("setCompressor", &_set_compressor<_at_universe_seeds_res>)
         .function("decode", __decode_ws_binary_as_str<_at_universe_seeds_res>)
         .function("seedData", &_get_seed_data)
     ;
 
+    class_<_universe_cache>("UniverseCache")
+        .constructor<>()
+        .function("setSchemaKey", &_universe_cache::set_schema_key)
+        .function("schemaKey", &_universe_cache::schema_key)
+        .function("load", &_universe_cache_load)
+        .function("save", &_universe_cache_save)
+        .function("isFresh", &_universe_cache::is_fresh)
+        .function("revision", &_universe_cache_revision)
+        .function("seeds", &_universe_cache_seeds)
+        .function("put", &_universe_cache::put)
+        .function("remove", &_universe_cache::remove)
+        .function("size", &_universe_cache::size)
+        .function("bytes", &_universe_cache::bytes)
+        .function("clear", &_universe_cache::clear)
+    ;
+
+    class_<_security_master>("SecurityMaster")
+        .constructor<>()
+        .function("add", &_security_master::add)
+        .function("lookup", &_security_master::lookup)
+        .function("prefixSearch", &_security_master::prefix_search)
+        .function("markets", &_security_master::markets)
+        .function("size", &_security_master::size)
+        .function("clear", &_security_master::clear)
+    ;
+
     class_<_at_fetch_by_code_req, base<_base_request>>("ATFetchByCodeReq")
         .constructor<>()
         .constructor<const std::string &,
@@ -445,9 +933,61 @@ EMSCRIPTEN_BINDINGS(test) {
         .function("decode", __decode_ws_binary_as_str<_at_fetch_sv_res>)
         .function("results", &_get_sv_res)
         .function("json_results", &_get_json_sv_res)
+        .function("columns", &_get_sv_res_columns)
+        .function("objects", &_get_sv_res_objects)
         .property("fields", &_at_fetch_sv_res::fields_)
         .property("namespace", &_at_fetch_sv_res::namespace_)
     ;
+    function("resample", &_resample);
+    function("resample", &_resample_local);
+    function("resample", &_resample_sessions);
+    class_<_resample_clock>("ResampleClock")
+        .constructor<int32_t, int32_t>()
+        .function("setSessions", &_resample_clock_set_sessions)
+        .function("bucket", &_resample_clock_bucket)
+    ;
+    class_<_at_fetch_sv_res_reader>("ATFetchSVResReader")
+        .constructor<_at_fetch_sv_res&, val, size_t>()
+        .function("valid", &_at_fetch_sv_res_reader::valid)
+        .function("complete", &_at_fetch_sv_res_reader::complete)
+        .function("count", &_at_fetch_sv_res_reader::count)
+        .function("position", &_at_fetch_sv_res_reader::position)
+        .function("remaining", &_at_fetch_sv_res_reader::remaining)
+        .function("next", &_at_fetch_sv_res_reader::next)
+    ;
+    class_<_bar_cache>("BarCache")
+        .constructor<size_t>()
+        .function("plan", &_bar_cache::plan)
+        .function("merge", &_bar_cache::merge)
+        .function("read", &_bar_cache::read)
+        .function("bytes", &_bar_cache::bytes)
+        .function("capacity", &_bar_cache::capacity)
+        .function("setCapacity", &_bar_cache::set_capacity)
+        .function("series", &_bar_cache::series)
+        .function("clear", &_bar_cache::clear)
+        .function("stats", &_bar_cache::stats)
+    ;
+    class_<_field_projection>("FieldProjection")
+        .constructor(&_make_field_projection)
+        .function("names", &_field_projection::names)
+        .function("mask", &_field_projection::mask)
+        .function("positions", &_field_projection::positions_of)
+    ;
+    class_<_sv_json_writer>("SVJsonWriter")
+        .constructor<>()
+        .function("setSchema", &_sv_json_writer::set_schema)
+        .function("setProjection", &_sv_json_writer::set_projection)
+        .function("setNamespaceLabels", &_sv_json_writer::set_namespace_labels)
+        .function("setNDJSON", &_sv_json_writer::set_ndjson)
+        .function("writeFetch", &_sv_json_writer::write_fetch)
+        .function("writeSubscribe", &_sv_json_writer::write_subscribe)
+        .function("writeSeeds", &_sv_json_writer::write_seeds)
+        .function("buffer", &_sv_json_writer::buffer)
+        .function("text", &_sv_json_writer::text)
+        .function("size", &_sv_json_writer::size)
+        .function("capacity", &_sv_json_writer::capacity)
+        .function("clear", &_sv_json_writer::clear)
+    ;
 
     enum_<_client_category>("ClientCategory")
         .value("None", _client_category::None)
@@ -1359,6 +1899,7 @@ EMSCRIPTEN_BINDINGS(test) {
         .function("int32VectorAt", &_formula_chart::get<int32_t>)
         .function("stringVectorAt", &_formula_chart::get<std::string>)
         .function("booleanVectorAt", &_formula_chart::getbool)
+        .function("seriesView", &_formula_chart_series_view)
         .DEF_PROPERTY2(type_, _formula_chart, "type")
         .DEF_PROPERTY2(name_, _formula_chart, "name")
         .DEF_PROPERTY2(function_name_, _formula_chart, "functionName")
@@ -1375,6 +1916,7 @@ EMSCRIPTEN_BINDINGS(test) {
         .DEF_PROPERTY2(charts_, _at_cal_formula_res, "charts")
         .DEF_PROPERTY2(doodles_, _at_cal_formula_res, "doodles")
         .DEF_PROPERTY2(time_tags_, _at_cal_formula_res, "timeTags")
+        .function("packColumns", &_cal_formula_res_pack_columns)
         // .DEF_PROPERTY2(formula_res, _at_cal_formula_res, "formulaRes")
 
     ;    
@@ -1392,6 +1934,20 @@ EMSCRIPTEN_BINDINGS(test) {
 
     ;    
 
+    class_<_formula_series_store>("FormulaSeriesStore")
+        .constructor<size_t>()
+        .function("load", &_formula_series_store::load)
+        .function("merge", &_formula_series_store::merge)
+        .function("remove", &_formula_series_store::remove)
+        .function("has", &_formula_series_store::has)
+        .function("uuids", &_formula_series_store::uuids)
+        .function("count", &_formula_series_store::count)
+        .function("seriesInfo", &_formula_series_store::series_info)
+        .function("timeTags", &_formula_series_store::time_tags)
+        .function("series", &_formula_series_store::series)
+        .function("capacity", &_formula_series_store::capacity)
+    ;
+
     register_map<std::string, std::string>("LibraryMap");
 
     class_<_at_reg_libraries_req, base<_at_base_formula_req>>("ATRegLibrariesReq")
@@ -1423,6 +1979,48 @@ EMSCRIPTEN_BINDINGS(test) {
         .DEF_DECODE(_at_subscribe_sv_res)
         .DEF_PROPERTY2(fields, _at_subscribe_sv_res, "fields")
     ;
+    class_<_subscription_snapshot_store>("SubscriptionSnapshotStore")
+        .constructor<>()
+        .function("apply", &_subscription_snapshot_store::apply)
+        .function("changed", &_subscription_snapshot_store::changed)
+        .function("tableCount", &_subscription_snapshot_store::table_count)
+        .function("tableOf", &_subscription_snapshot_store::table_of)
+        .function("tableOfRevision", &_subscription_snapshot_store::table_of_revision)
+        .function("find", &_subscription_snapshot_store::find)
+        .function("tableInfo", &_subscription_snapshot_store::table_info)
+        .function("values", &_subscription_snapshot_store::values)
+        .function("timeTags", &_subscription_snapshot_store::time_tags)
+        .function("rowValues", &_subscription_snapshot_store::row_values)
+        .function("rowKey", &_subscription_snapshot_store::row_key_of)
+        .function("latest", &_subscription_snapshot_store::latest)
+        .function("clear", &_subscription_snapshot_store::clear)
+    ;
+    class_<_snapshot_delta_encoder>("SnapshotDeltaEncoder")
+        .constructor<>()
+        .function("encode", &_snapshot_delta_encoder::encode)
+        .function("encodeFull", &_snapshot_delta_encoder::encode_full)
+        .function("reset", &_snapshot_delta_encoder::reset)
+        .function("size", &_snapshot_delta_encoder::size)
+    ;
+    class_<_snapshot_delta_decoder>("SnapshotDeltaDecoder")
+        .constructor<>()
+        .function("decode", &_snapshot_delta_decoder::decode)
+        .function("row", &_snapshot_delta_decoder::row)
+        .function("reset", &_snapshot_delta_decoder::reset)
+    ;
+    constant("DECODE_FETCH", (int32_t)DECODE_FETCH);
+    constant("DECODE_SEEDS", (int32_t)DECODE_SEEDS);
+    class_<_decode_pool>("DecodePool")
+        .constructor<size_t>()
+        .function("setSchema", &_decode_pool::set_schema)
+        .function("setListener", &_decode_pool::set_listener)
+        .function("submit", &_decode_pool::submit)
+        .function("completed", &_decode_pool::completed)
+        .function("takeFetch", &_decode_pool::take_fetch)
+        .function("takeSeeds", &_decode_pool::take_seeds)
+        .function("threads", &_decode_pool::threads)
+        .function("pending", &_decode_pool::pending)
+    ;
 
     enum_<_market_state>("MarketState")
         .value("Open", _market_state::Open)
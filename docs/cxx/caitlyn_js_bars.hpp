@@ -0,0 +1,435 @@
+#ifndef __CAITLYN_JS_BARS_HPP__
+#define __CAITLYN_JS_BARS_HPP__
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_meta.hpp>
+#include <caitlyn_js_columns.hpp>
+
+// time tags of a request as signed ms, clear of overflow at the top end
+inline int64_t __bar_time_tag(uint64_t v) {
+    return (int64_t)std::min<uint64_t>(v, (uint64_t)std::numeric_limits<int64_t>::max() - 1);
+}
+
+struct _bar_key {
+    uint32_t ns;
+    uint32_t meta_id;
+    uint32_t revision;
+    std::string market;
+    std::string code;
+    int32_t granularity;
+
+    bool operator<(const _bar_key& o) const {
+        return std::tie(ns, meta_id, revision, market, code, granularity)
+            < std::tie(o.ns, o.meta_id, o.revision, o.market, o.code, o.granularity);
+    }
+};
+
+/*
+ * Bars of one (namespace, meta, revision, market, code, granularity): every
+ * numeric field of the meta as a column, rows in time tag order with unique
+ * time tags, and the time ranges known to be complete. Covered ranges are
+ * inclusive at both ends like ATFetchByCodeReq, disjoint and never adjacent.
+ */
+class _bar_series {
+public:
+    explicit _bar_series(const _index_meta& meta) {
+        for(size_t i = 0; i < meta.fields_.size(); i++){
+            if(_sv_column::is_numeric(meta.fields_[i].type_)){
+                _sv_column __col;
+                __col.name = meta.fields_[i].name_;
+                __col.pos = (int32_t)i;
+                __col.type = meta.fields_[i].type_;
+                m_columns.push_back(__col);
+            }
+        }
+    }
+    // upserts rows by time tag, a fetched row replaces the cached one; returns rows written
+    size_t merge(const std::vector<_sv_ptr>& rows) {
+        std::vector<std::pair<int64_t, size_t> > __in;
+        __in.reserve(rows.size());
+        for(size_t i = 0; i < rows.size(); i++){
+            __in.push_back(std::make_pair((int64_t)rows[i]->getTimeTag(), i));
+        }
+        std::stable_sort(__in.begin(), __in.end(),
+            [](const std::pair<int64_t, size_t>& a, const std::pair<int64_t, size_t>& b){ return a.first < b.first; });
+        std::vector<int64_t> __time_tags;
+        std::vector<_sv_column> __columns(m_columns);
+        __time_tags.reserve(m_time_tags.size() + __in.size());
+        for(size_t c = 0; c < __columns.size(); c++){
+            __columns[c].i32.clear();
+            __columns[c].f64.clear();
+            __columns[c].i64.clear();
+            __columns[c].reserve(m_time_tags.size() + __in.size());
+        }
+        size_t __written = 0;
+        size_t i = 0, j = 0;
+        while(i < m_time_tags.size() || j < __in.size()){
+            // of equal fetched time tags the last one wins
+            if(j + 1 < __in.size() && __in[j + 1].first == __in[j].first){
+                j++;
+                continue;
+            }
+            if(j == __in.size() || (i < m_time_tags.size() && m_time_tags[i] < __in[j].first)){
+                __time_tags.push_back(m_time_tags[i]);
+                for(size_t c = 0; c < __columns.size(); c++){
+                    __columns[c].append(m_columns[c], i);
+                }
+                i++;
+                continue;
+            }
+            if(i < m_time_tags.size() && m_time_tags[i] == __in[j].first){
+                i++;
+            }
+            __time_tags.push_back(__in[j].first);
+            for(size_t c = 0; c < __columns.size(); c++){
+                __columns[c].append(*rows[__in[j].second]);
+            }
+            __written++;
+            j++;
+        }
+        m_time_tags.swap(__time_tags);
+        m_columns.swap(__columns);
+        return __written;
+    }
+    // marks [from, to] complete, joining overlapping and adjacent ranges
+    void cover(int64_t from, int64_t to) {
+        if(from > to){
+            return;
+        }
+        std::map<int64_t, int64_t>::iterator it = m_covered.upper_bound(from);
+        if(it != m_covered.begin()){
+            std::map<int64_t, int64_t>::iterator __prev = it;
+            --__prev;
+            if(__prev->second >= from - 1){
+                it = __prev;
+            }
+        }
+        while(it != m_covered.end() && it->first <= to + 1){
+            from = std::min(from, it->first);
+            to = std::max(to, it->second);
+            m_covered.erase(it++);
+        }
+        m_covered[from] = to;
+    }
+    // sub-ranges of [from, to] not covered, in time order
+    void gaps(int64_t from, int64_t to, std::vector<std::pair<int64_t, int64_t> >& out) const {
+        int64_t __cursor = from;
+        std::map<int64_t, int64_t>::const_iterator it = m_covered.upper_bound(from);
+        if(it != m_covered.begin()){
+            --it;
+        }
+        for(; it != m_covered.end() && it->first <= to && __cursor <= to; ++it){
+            if(it->second < __cursor){
+                continue;
+            }
+            if(it->first > __cursor){
+                out.push_back(std::make_pair(__cursor, it->first - 1));
+            }
+            __cursor = it->second + 1;
+        }
+        if(__cursor <= to){
+            out.push_back(std::make_pair(__cursor, to));
+        }
+    }
+    bool has_columns(const std::vector<std::string>& names) const {
+        for(size_t i = 0; i < names.size(); i++){
+            if(!column(names[i])){
+                return false;
+            }
+        }
+        return true;
+    }
+    // rows in [from, to] in the ATFetchSVRes.columns() layout, fields limited to names
+    emscripten::val read(const _bar_key& key, int64_t from, int64_t to, const std::vector<std::string>& names, size_t field_count) const {
+        size_t __begin = std::lower_bound(m_time_tags.begin(), m_time_tags.end(), from) - m_time_tags.begin();
+        size_t __end = std::upper_bound(m_time_tags.begin(), m_time_tags.end(), to) - m_time_tags.begin();
+        __end = std::max(__begin, __end);
+        size_t __count = __end - __begin;
+        emscripten::val __ret = emscripten::val::object();
+        emscripten::val __fields = emscripten::val::object();
+        __ret.set("count", __count);
+        __ret.set("namespace", key.ns);
+        __ret.set("metaID", key.meta_id);
+        __ret.set("fieldCount", field_count);
+        __ret.set("timeTags", __to_typed_array(m_time_tags.empty() ? (const int64_t*)0 : &m_time_tags[0] + __begin, __count, "BigInt64Array"));
+        // one market and code: every index is 0
+        std::vector<int32_t> __zeros(__count, 0);
+        __ret.set("markets", __to_typed_array(__zeros, "Int32Array"));
+        __ret.set("codes", __to_typed_array(__zeros, "Int32Array"));
+        __ret.set("marketDict", __to_string_array(std::vector<std::string>(1, key.market)));
+        __ret.set("codeDict", __to_string_array(std::vector<std::string>(1, key.code)));
+        for(size_t i = 0; i < names.size(); i++){
+            const _sv_column* __col = column(names[i]);
+            if(__col){
+                __fields.set(names[i], __col->to_js(__begin, __end));
+            }
+        }
+        __ret.set("fields", __fields);
+        return __ret;
+    }
+    size_t rows() const {
+        return m_time_tags.size();
+    }
+    size_t bytes() const {
+        size_t __ret = sizeof(_bar_series) + m_time_tags.size() * sizeof(int64_t)
+            + m_covered.size() * (2 * sizeof(int64_t) + 4 * sizeof(void*));
+        for(size_t c = 0; c < m_columns.size(); c++){
+            __ret += sizeof(_sv_column) + m_columns[c].bytes();
+        }
+        return __ret;
+    }
+private:
+    const _sv_column* column(const std::string& name) const {
+        for(size_t c = 0; c < m_columns.size(); c++){
+            if(m_columns[c].name == name){
+                return &m_columns[c];
+            }
+        }
+        return 0;
+    }
+
+    std::vector<int64_t> m_time_tags;
+    std::vector<_sv_column> m_columns;
+    std::map<int64_t, int64_t> m_covered;   // from -> to
+};
+
+/*
+ * Historical bars of ATFetchByCodeReq queries, kept across requests.
+ * plan() turns a request into copies of it for just the time ranges the cache
+ * lacks; once their responses went through merge(), read() serves the whole
+ * range from the cache. Series are keyed by (namespace, meta, revision,
+ * market, code, granularity), the revision being the request's or, for
+ * "latest" (-1), the loaded schema's, so a new meta revision starts a new
+ * series laid out from that revision's fields. Only records of the series'
+ * market, code and revision are merged into it. Gap requests ask for every
+ * numeric field of the meta, a cached bar is complete whatever fields later
+ * requests want. Memory is bounded by capacity bytes, least recently used
+ * series are dropped first.
+ */
+class _bar_cache {
+public:
+    explicit _bar_cache(size_t capacity)
+        :m_bytes(0), m_capacity(capacity), m_hits(0), m_misses(0), m_evictions(0) {}
+
+    /*
+     * Array of ATFetchByCodeReq covering the missing parts of req's range,
+     * empty when the cache has all of it. null when the meta or the requested
+     * revision is not loaded or a field is not numeric; such queries are
+     * fetched without the cache.
+     */
+    emscripten::val plan(const _at_fetch_by_code_req& req, emscripten::val field_names) {
+        _bar_key __key;
+        const _index_meta* __meta = 0;
+        _schema_image_ptr __image = _meta_directory::instance().image();
+        if(!key_of(*__image, req, __key, __meta) || !numeric_fields(*__meta, emscripten::vecFromJSArray<std::string>(field_names))){
+            return emscripten::val::null();
+        }
+        int64_t __from = __bar_time_tag(req.from_time_tag);
+        int64_t __to = __bar_time_tag(req.to_time_tag);
+        std::vector<std::pair<int64_t, int64_t> > __gaps;
+        std::map<_bar_key, _entry>::iterator it = m_series.find(__key);
+        if(it == m_series.end()){
+            if(__from <= __to){
+                __gaps.push_back(std::make_pair(__from, __to));
+            }
+        }else{
+            touch(it->second);
+            it->second.series->gaps(__from, __to, __gaps);
+        }
+        if(__gaps.empty()) m_hits++;
+        else m_misses++;
+        std::vector<std::string> __fields;
+        for(size_t i = 0; i < __meta->fields_.size(); i++){
+            if(_sv_column::is_numeric(__meta->fields_[i].type_)){
+                __fields.push_back(__meta->fields_[i].name_);
+            }
+        }
+        emscripten::val __ret = emscripten::val::array();
+        for(size_t i = 0; i < __gaps.size(); i++){
+            boost::shared_ptr<_at_fetch_by_code_req> __gap = boost::make_shared<_at_fetch_by_code_req>(req);
+            __gap->from_time_tag = (uint64_t)__gaps[i].first;
+            __gap->to_time_tag = (uint64_t)__gaps[i].second;
+            __gap->fields = __fields;
+            __ret.call<void>("push", __gap);
+        }
+        return __ret;
+    }
+    /*
+     * Stores the records of the response to a plan() request and marks its
+     * range complete up to covered_to (ms): the bar still forming at the end
+     * of a range up to now should be fetched again. Returns rows written.
+     */
+    size_t merge(const _at_fetch_by_code_req& req, _at_fetch_sv_res& res, double covered_to) {
+        _bar_key __key;
+        const _index_meta* __meta = 0;
+        _schema_image_ptr __image = _meta_directory::instance().image();
+        if(!key_of(*__image, req, __key, __meta)){
+            return 0;
+        }
+        std::vector<_sv_ptr> __rows = _get_sv_res(res);
+        std::vector<_sv_ptr> __matching;
+        __matching.reserve(__rows.size());
+        for(size_t i = 0; i < __rows.size(); i++){
+            _sv& __sv = *__rows[i];
+            if((uint32_t)__sv.getNamespace() == __key.ns && (uint32_t)__sv.getMetaID() == __key.meta_id
+                && (uint32_t)__sv.getRevision() == __key.revision && __sv.getMarket() == __key.market && __sv.getStockCode() == __key.code){
+                __matching.push_back(__rows[i]);
+            }
+        }
+        std::map<_bar_key, _entry>::iterator it = m_series.find(__key);
+        if(it == m_series.end()){
+            m_lru.push_front(__key);
+            _entry __entry = {boost::make_shared<_bar_series>(*__meta), m_lru.begin(), 0};
+            it = m_series.insert(std::make_pair(__key, __entry)).first;
+        }
+        _entry& __entry = it->second;
+        touch(__entry);
+        size_t __written = __entry.series->merge(__matching);
+        int64_t __to = __bar_time_tag(req.to_time_tag);
+        if(covered_to < (double)__to){
+            __to = covered_to > 0 ? (int64_t)covered_to : -1;
+        }
+        __entry.series->cover(__bar_time_tag(req.from_time_tag), __to);
+        account(__entry);
+        evict(&__key);
+        return __written;
+    }
+    // rows of req's range in the ATFetchSVRes.columns() layout, null when nothing is cached for it
+    emscripten::val read(const _at_fetch_by_code_req& req, emscripten::val field_names) {
+        _bar_key __key;
+        const _index_meta* __meta = 0;
+        _schema_image_ptr __image = _meta_directory::instance().image();
+        if(!key_of(*__image, req, __key, __meta)){
+            return emscripten::val::null();
+        }
+        std::map<_bar_key, _entry>::iterator it = m_series.find(__key);
+        if(it == m_series.end()){
+            return emscripten::val::null();
+        }
+        touch(it->second);
+        return it->second.series->read(__key, __bar_time_tag(req.from_time_tag), __bar_time_tag(req.to_time_tag),
+            emscripten::vecFromJSArray<std::string>(field_names), __meta->fields_.size());
+    }
+    size_t bytes() const {
+        return m_bytes;
+    }
+    size_t capacity() const {
+        return m_capacity;
+    }
+    void set_capacity(size_t capacity) {
+        m_capacity = capacity;
+        evict(0);
+    }
+    size_t series() const {
+        return m_series.size();
+    }
+    void clear() {
+        m_series.clear();
+        m_lru.clear();
+        m_bytes = 0;
+    }
+    // {series, rows, bytes, capacity, hits, misses, evictions}; a hit is a plan() without gaps
+    emscripten::val stats() const {
+        size_t __rows = 0;
+        for(std::map<_bar_key, _entry>::const_iterator it = m_series.begin(); it != m_series.end(); ++it){
+            __rows += it->second.series->rows();
+        }
+        emscripten::val __ret = emscripten::val::object();
+        __ret.set("series", m_series.size());
+        __ret.set("rows", __rows);
+        __ret.set("bytes", m_bytes);
+        __ret.set("capacity", m_capacity);
+        __ret.set("hits", (double)m_hits);
+        __ret.set("misses", (double)m_misses);
+        __ret.set("evictions", (double)m_evictions);
+        return __ret;
+    }
+private:
+    typedef std::list<_bar_key> _lru;
+    struct _entry {
+        boost::shared_ptr<_bar_series> series;
+        _lru::iterator lru;
+        size_t bytes;
+    };
+
+    // namespace is "global"/"private" or "0"/"1"; the qualified name may omit the "namespace::" prefix.
+    // meta is the requested revision, false when that revision is not loaded
+    static bool key_of(const _schema_image& image, const _at_fetch_by_code_req& req, _bar_key& key, const _index_meta*& meta) {
+        uint32_t __ns = req._ns == "private" || req._ns == "1" ? 1 : 0;
+        meta = 0;
+        for(std::map<_meta_key, _index_meta>::const_iterator it = image.metas.lower_bound(_meta_key(__ns, 0)); it != image.metas.end() && it->first.first == __ns; ++it){
+            const std::string& __name = it->second.name_;
+            size_t __sep = __name.rfind("::");
+            if(__name == req.qualified_name || (__sep != std::string::npos && __name.compare(__sep + 2, std::string::npos, req.qualified_name) == 0)){
+                meta = &it->second;
+                break;
+            }
+        }
+        if(meta && (uint32_t)req.revision != 0xffffffffu){
+            meta = image.find(__ns, (uint32_t)meta->id_, (uint32_t)req.revision);
+        }
+        if(!meta){
+            return false;
+        }
+        key.ns = __ns;
+        key.meta_id = (uint32_t)meta->id_;
+        key.revision = (uint32_t)meta->revision_;
+        key.market = req.market;
+        key.code = req.code;
+        key.granularity = (int32_t)req.granularity;
+        return true;
+    }
+    static bool numeric_fields(const _index_meta& meta, const std::vector<std::string>& names) {
+        for(size_t i = 0; i < names.size(); i++){
+            int32_t __pos = _meta_directory::field_pos(meta, names[i]);
+            if(__pos < 0 || !_sv_column::is_numeric(meta.fields_[__pos].type_)){
+                return false;
+            }
+        }
+        return true;
+    }
+    void touch(_entry& entry) {
+        m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+    }
+    void account(_entry& entry) {
+        size_t __bytes = entry.series->bytes() + sizeof(_bar_key) + entry.lru->market.size() + entry.lru->code.size();
+        m_bytes = m_bytes - entry.bytes + __bytes;
+        entry.bytes = __bytes;
+    }
+    // drops least recently used series until within capacity, sparing keep
+    void evict(const _bar_key* keep) {
+        _lru::iterator it = m_lru.end();
+        while(m_bytes > m_capacity && it != m_lru.begin()){
+            --it;
+            if(keep && !(*it < *keep) && !(*keep < *it)){
+                continue;
+            }
+            std::map<_bar_key, _entry>::iterator __series = m_series.find(*it);
+            m_bytes -= __series->second.bytes;
+            m_series.erase(__series);
+            it = m_lru.erase(it);
+            m_evictions++;
+        }
+    }
+    std::map<_bar_key, _entry> m_series;
+    _lru m_lru;                 // most recently used first
+    size_t m_bytes;
+    size_t m_capacity;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_evictions;
+};
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef __CAITLYN_JS_COLUMNS_HPP__
+#define __CAITLYN_JS_COLUMNS_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_meta.hpp>
+
+// copies n native values into a JS owned typed array, e.g. "Float64Array"
+template<typename T>
+emscripten::val __to_typed_array(const T* data, size_t n, const char* ctor) {
+    emscripten::val __arr = emscripten::val::global(ctor).new_(n);
+    if(n){
+        __arr.call<void>("set", emscripten::val(emscripten::typed_memory_view(n, data)));
+    }
+    return __arr;
+}
+
+template<typename T>
+emscripten::val __to_typed_array(const std::vector<T>& data, const char* ctor) {
+    return __to_typed_array(data.empty() ? (const T*)0 : &data[0], data.size(), ctor);
+}
+
+// strings [begin, end) of data
+inline emscripten::val __to_string_array(const std::vector<std::string>& data, size_t begin = 0) {
+    emscripten::val __arr = emscripten::val::array();
+    for(size_t i = begin; i < data.size(); i++){
+        __arr.set(i - begin, data[i]);
+    }
+    return __arr;
+}
+
+// interns strings into a dictionary and hands back their index
+class _string_dict {
+public:
+    int32_t intern(const std::string& s) {
+        boost::unordered_map<std::string, int32_t>::iterator it = m_index.find(s);
+        if(it != m_index.end()){
+            return it->second;
+        }
+        int32_t __id = (int32_t)m_values.size();
+        m_index[s] = __id;
+        m_values.push_back(s);
+        return __id;
+    }
+    // index of s, -1 when it was never interned
+    int32_t find(const std::string& s) const {
+        boost::unordered_map<std::string, int32_t>::const_iterator it = m_index.find(s);
+        return it == m_index.end() ? -1 : it->second;
+    }
+    const std::vector<std::string>& values() const {
+        return m_values;
+    }
+    void clear() {
+        m_index.clear();
+        m_values.clear();
+    }
+private:
+    boost::unordered_map<std::string, int32_t> m_index;
+    std::vector<std::string> m_values;
+};
+
+/*
+ * One numeric field of a meta laid out as a column. INT fields become
+ * Int32Array, DOUBLE Float64Array and INT64 BigInt64Array; empty doubles are
+ * NaN and empty integers 0. String and vector fields are not columnar.
+ */
+struct _sv_column {
+    std::string name;
+    int32_t pos;
+    _data_type type;
+    std::vector<int32_t> i32;
+    std::vector<double> f64;
+    std::vector<int64_t> i64;
+
+    static bool is_numeric(_data_type t) {
+        return t == _data_type::INT || t == _data_type::DOUBLE || t == _data_type::INT64;
+    }
+    void reserve(size_t n) {
+        if(type == _data_type::INT) i32.reserve(n);
+        else if(type == _data_type::DOUBLE) f64.reserve(n);
+        else i64.reserve(n);
+    }
+    void append(_sv& sv) {
+        bool __empty = pos >= (int32_t)sv.size() || sv.isEmpty(pos);
+        if(type == _data_type::INT){
+            i32.push_back(__empty ? 0 : sv.getInt(pos));
+        }else if(type == _data_type::DOUBLE){
+            f64.push_back(__empty ? std::numeric_limits<double>::quiet_NaN() : sv.getDouble(pos));
+        }else{
+            i64.push_back(__empty ? 0 : sv.getInt64(pos));
+        }
+    }
+    // row of another column of the same type
+    void append(const _sv_column& from, size_t row) {
+        if(type == _data_type::INT) i32.push_back(from.i32[row]);
+        else if(type == _data_type::DOUBLE) f64.push_back(from.f64[row]);
+        else i64.push_back(from.i64[row]);
+    }
+    size_t bytes() const {
+        return i32.size() * sizeof(int32_t) + f64.size() * sizeof(double) + i64.size() * sizeof(int64_t);
+    }
+    emscripten::val to_js() const {
+        if(type == _data_type::INT) return __to_typed_array(i32, "Int32Array");
+        if(type == _data_type::DOUBLE) return __to_typed_array(f64, "Float64Array");
+        return __to_typed_array(i64, "BigInt64Array");
+    }
+    // rows [begin, end)
+    emscripten::val to_js(size_t begin, size_t end) const {
+        if(type == _data_type::INT) return __to_typed_array(i32.empty() ? (const int32_t*)0 : &i32[0] + begin, end - begin, "Int32Array");
+        if(type == _data_type::DOUBLE) return __to_typed_array(f64.empty() ? (const double*)0 : &f64[0] + begin, end - begin, "Float64Array");
+        return __to_typed_array(i64.empty() ? (const int64_t*)0 : &i64[0] + begin, end - begin, "BigInt64Array");
+    }
+};
+
+/*
+ * Columnar builder over decoded StructValues of a single meta.
+ * Rows are appended in one pass; every requested numeric field, the time tags
+ * and dictionary indices of market and code grow side by side.
+ */
+class _sv_columns {
+public:
+    _sv_columns():m_meta(0), m_requested(0) {}
+
+    // resolves field names against the meta of the first row, false if the schema is unknown
+    bool bind(_sv& first, const std::vector<std::string>& field_names) {
+        // pin the schema image, readers keep m_meta across event loop turns
+        m_image = _meta_directory::instance().image();
+        std::map<_meta_key, _index_meta>::const_iterator it = m_image->metas.find(_meta_key((uint32_t)first.getNamespace(), (uint32_t)first.getMetaID()));
+        m_meta = it == m_image->metas.end() ? 0 : &it->second;
+        m_columns.clear();
+        m_requested = field_names.size();
+        if(!m_meta){
+            return false;
+        }
+        for(size_t i = 0; i < field_names.size(); i++){
+            int32_t __pos = _meta_directory::field_pos(*m_meta, field_names[i]);
+            if(__pos < 0 || !_sv_column::is_numeric(m_meta->fields_[__pos].type_)){
+                continue;
+            }
+            _sv_column __col;
+            __col.name = field_names[i];
+            __col.pos = __pos;
+            __col.type = m_meta->fields_[__pos].type_;
+            m_columns.push_back(__col);
+        }
+        return true;
+    }
+    void reserve(size_t n) {
+        m_time_tags.reserve(n);
+        m_markets.reserve(n);
+        m_codes.reserve(n);
+        for(size_t i = 0; i < m_columns.size(); i++){
+            m_columns[i].reserve(n);
+        }
+    }
+    void append(_sv& sv) {
+        m_time_tags.push_back((int64_t)sv.getTimeTag());
+        m_markets.push_back(m_market_dict.intern(sv.getMarket()));
+        m_codes.push_back(m_code_dict.intern(sv.getStockCode()));
+        for(size_t i = 0; i < m_columns.size(); i++){
+            m_columns[i].append(sv);
+        }
+    }
+    size_t count() const {
+        return m_time_tags.size();
+    }
+    // every requested field was bound as a column
+    bool complete() const {
+        return m_meta && m_columns.size() == m_requested;
+    }
+    size_t market_dict_size() const {
+        return m_market_dict.values().size();
+    }
+    size_t code_dict_size() const {
+        return m_code_dict.values().size();
+    }
+    // clears the rows but keeps the bound fields and dictionaries
+    void clear_rows() {
+        m_time_tags.clear();
+        m_markets.clear();
+        m_codes.clear();
+        for(size_t i = 0; i < m_columns.size(); i++){
+            m_columns[i].i32.clear();
+            m_columns[i].f64.clear();
+            m_columns[i].i64.clear();
+        }
+    }
+    /*
+     * {count, namespace, metaID, fieldCount, timeTags: BigInt64Array,
+     *  markets: Int32Array, codes: Int32Array, marketDict: [string],
+     *  codeDict: [string], fields: {name: TypedArray}}
+     * With bases, marketDict and codeDict only hold the entries interned since
+     * the dictionaries had market_base and code_base entries.
+     */
+    emscripten::val to_js(size_t market_base = 0, size_t code_base = 0) const {
+        emscripten::val __ret = emscripten::val::object();
+        emscripten::val __fields = emscripten::val::object();
+        __ret.set("count", count());
+        if(m_meta){
+            __ret.set("namespace", (uint32_t)m_meta->namespace_);
+            __ret.set("metaID", (uint32_t)m_meta->id_);
+            __ret.set("fieldCount", m_meta->fields_.size());
+        }
+        __ret.set("timeTags", __to_typed_array(m_time_tags, "BigInt64Array"));
+        __ret.set("markets", __to_typed_array(m_markets, "Int32Array"));
+        __ret.set("codes", __to_typed_array(m_codes, "Int32Array"));
+        __ret.set("marketDict", __to_string_array(m_market_dict.values(), market_base));
+        __ret.set("codeDict", __to_string_array(m_code_dict.values(), code_base));
+        for(size_t i = 0; i < m_columns.size(); i++){
+            __fields.set(m_columns[i].name, m_columns[i].to_js());
+        }
+        __ret.set("fields", __fields);
+        return __ret;
+    }
+private:
+    _schema_image_ptr m_image;
+    const _index_meta* m_meta;
+    size_t m_requested;
+    std::vector<_sv_column> m_columns;
+    std::vector<int64_t> m_time_tags;
+    std::vector<int32_t> m_markets;
+    std::vector<int32_t> m_codes;
+    _string_dict m_market_dict;
+    _string_dict m_code_dict;
+};
+
+// ATFetchSVRes.columns(fieldNames): null when the meta is not in the loaded schema
+inline emscripten::val _get_sv_res_columns(_at_fetch_sv_res& res, emscripten::val field_names) {
+    std::vector<_sv_ptr> __rows = _get_sv_res(res);
+    std::vector<std::string> __names = emscripten::vecFromJSArray<std::string>(field_names);
+    _sv_columns __columns;
+    if(!__rows.empty()){
+        if(!__columns.bind(*__rows[0], __names)){
+            return emscripten::val::null();
+        }
+        __columns.reserve(__rows.size());
+        for(size_t i = 0; i < __rows.size(); i++){
+            __columns.append(*__rows[i]);
+        }
+    }
+    return __columns.to_js();
+}
+
+/*
+ * Cursor over the records of a decoded ATFetchSVRes.
+ * The response is decoded as a whole before the reader sees it; the reader
+ * takes its own references to the StructValues, so the response can be
+ * deleted right after construction. next() exports up to chunk_size records
+ * in the columns() layout and drops the reader's reference to each exported
+ * record, which spreads the JS side conversion over several event loop turns.
+ * It does not lower the peak WASM heap: every record of the response is
+ * materialized before the reader is constructed.
+ * Market and code indices run across chunks: each chunk's marketDict and
+ * codeDict only hold the entries first seen in it, marketDictBase and
+ * codeDictBase give the index of their first entry.
+ */
+class _at_fetch_sv_res_reader {
+public:
+    _at_fetch_sv_res_reader(_at_fetch_sv_res& res, emscripten::val field_names, size_t chunk_size)
+        :m_rows(_get_sv_res(res)), m_cursor(0), m_chunk_size(chunk_size ? chunk_size : 1), m_valid(true), m_complete(true)
+    {
+        if(!m_rows.empty()){
+            m_valid = m_columns.bind(*m_rows[0], emscripten::vecFromJSArray<std::string>(field_names));
+            m_complete = m_columns.complete();
+        }
+        m_columns.reserve(std::min(m_chunk_size, m_rows.size()));
+    }
+
+    // false when the meta of the records is not in the loaded schema
+    bool valid() const {
+        return m_valid;
+    }
+    // every requested field is a numeric field of the meta, so chunks carry them all
+    bool complete() const {
+        return m_valid && m_complete;
+    }
+    size_t count() const {
+        return m_rows.size();
+    }
+    size_t position() const {
+        return m_cursor;
+    }
+    size_t remaining() const {
+        return m_rows.size() - m_cursor;
+    }
+    // next chunk of records in columns() layout, null once exhausted
+    emscripten::val next() {
+        if(!m_valid || m_cursor >= m_rows.size()){
+            return emscripten::val::null();
+        }
+        size_t __end = std::min(m_cursor + m_chunk_size, m_rows.size());
+        size_t __market_base = m_columns.market_dict_size();
+        size_t __code_base = m_columns.code_dict_size();
+        m_columns.clear_rows();
+        for(; m_cursor < __end; m_cursor++){
+            m_columns.append(*m_rows[m_cursor]);
+            m_rows[m_cursor].reset();
+        }
+        emscripten::val __ret = m_columns.to_js(__market_base, __code_base);
+        __ret.set("marketDictBase", __market_base);
+        __ret.set("codeDictBase", __code_base);
+        return __ret;
+    }
+private:
+    std::vector<_sv_ptr> m_rows;
+    size_t m_cursor;
+    size_t m_chunk_size;
+    bool m_valid;
+    bool m_complete;
+    _sv_columns m_columns;
+};
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef __CAITLYN_JS_DELTA_HPP__
+#define __CAITLYN_JS_DELTA_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_snapshot.hpp>
+
+/*
+ * Snapshot delta stream, little endian:
+ *   header  'S' 'D' u8 version u8 0, u32 record count
+ *   TABLE   u8 1, u32 table, u32 namespace, u32 metaID, u32 revision,
+ *           u16 width, width * (u16 length, name bytes)
+ *   ROW     u8 2, u32 table, u32 row, i32 granularity, u16+market, u16+code,
+ *           i64 timeTag, width * f64
+ *   DELTA   u8 3, u32 table, u32 row, i64 timeTag, ceil(width / 8) mask bytes,
+ *           one f64 per set mask bit in field order
+ * TABLE precedes the first ROW of a table and is resent whenever the store
+ * relays the table out after its revision was replaced, which renumbers its
+ * rows; ROW precedes the first DELTA of a row.
+ */
+const uint8_t __DELTA_VERSION = 1;
+enum _delta_record {
+    DELTA_TABLE = 1,
+    DELTA_ROW = 2,
+    DELTA_CHANGE = 3
+};
+
+class _delta_writer {
+public:
+    explicit _delta_writer(ByteArray& out):m_out(out) {}
+
+    template<typename T>
+    void put(T v) {
+        size_t __n = m_out.size();
+        m_out.resize(__n + sizeof(T));
+        memcpy(&m_out[__n], &v, sizeof(T));
+    }
+    void put_string(const std::string& s) {
+        uint16_t __len = (uint16_t)std::min(s.size(), (size_t)0xffff);
+        put(__len);
+        m_out.insert(m_out.end(), s.begin(), s.begin() + __len);
+    }
+    void put_bytes(const uint8_t* p, size_t n) {
+        m_out.insert(m_out.end(), p, p + n);
+    }
+private:
+    ByteArray& m_out;
+};
+
+class _delta_reader {
+public:
+    _delta_reader(const uint8_t* p, size_t n):m_p(p), m_end(p + n), m_ok(true) {}
+
+    template<typename T>
+    T get() {
+        T __v = T();
+        if(m_end - m_p < (ptrdiff_t)sizeof(T)){
+            m_ok = false;
+            m_p = m_end;
+            return __v;
+        }
+        memcpy(&__v, m_p, sizeof(T));
+        m_p += sizeof(T);
+        return __v;
+    }
+    std::string get_string() {
+        uint16_t __len = get<uint16_t>();
+        if(m_end - m_p < (ptrdiff_t)__len){
+            m_ok = false;
+            m_p = m_end;
+            return std::string();
+        }
+        std::string __s((const char*)m_p, __len);
+        m_p += __len;
+        return __s;
+    }
+    const uint8_t* get_bytes(size_t n) {
+        if(m_end - m_p < (ptrdiff_t)n){
+            m_ok = false;
+            m_p = m_end;
+            return 0;
+        }
+        const uint8_t* __ret = m_p;
+        m_p += n;
+        return __ret;
+    }
+    bool ok() const {
+        return m_ok;
+    }
+private:
+    const uint8_t* m_p;
+    const uint8_t* m_end;
+    bool m_ok;
+};
+
+/*
+ * Encodes what the last SubscriptionSnapshotStore.apply() changed, for one
+ * downstream consumer. The encoder remembers which tables and rows that
+ * consumer has already been sent, so use one encoder per client stream and
+ * call reset() (or encodeFull()) when the client reconnects. Change masks
+ * only cover the last apply(), so encode() has to run after every apply().
+ */
+class _snapshot_delta_encoder {
+public:
+    _snapshot_delta_encoder():m_records(0) {}
+
+    // view over the encoded update, valid until the next encode
+    emscripten::val encode(const _subscription_snapshot_store& store) {
+        begin();
+        const std::vector<_snapshot_table>& __tables = store.tables();
+        const std::vector<int32_t>& __changed = store.changed_rows();
+        for(size_t i = 0; i + 1 < __changed.size(); i += 2){
+            write_row(__tables, __changed[i], __changed[i + 1]);
+        }
+        return finish();
+    }
+    // every row of the store, as for a newly connected client
+    emscripten::val encode_full(const _subscription_snapshot_store& store) {
+        reset();
+        begin();
+        const std::vector<_snapshot_table>& __tables = store.tables();
+        for(size_t t = 0; t < __tables.size(); t++){
+            for(size_t r = 0; r < __tables[t].row_count(); r++){
+                write_row(__tables, (int32_t)t, (int32_t)r);
+            }
+        }
+        return finish();
+    }
+    void reset() {
+        m_table_layouts.clear();
+        m_rows_sent.clear();
+    }
+    size_t size() const {
+        return m_out.size();
+    }
+private:
+    void begin() {
+        m_out.clear();
+        m_records = 0;
+        _delta_writer __w(m_out);
+        __w.put<uint8_t>('S');
+        __w.put<uint8_t>('D');
+        __w.put<uint8_t>(__DELTA_VERSION);
+        __w.put<uint8_t>(0);
+        __w.put<uint32_t>(0);
+    }
+    emscripten::val finish() {
+        memcpy(&m_out[4], &m_records, sizeof(m_records));
+        return emscripten::val(emscripten::typed_memory_view(m_out.size(), m_out.data()));
+    }
+
+    void write_row(const std::vector<_snapshot_table>& tables, int32_t table, int32_t row) {
+        const _snapshot_table& __t = tables[table];
+        _delta_writer __w(m_out);
+        if((size_t)table >= m_table_layouts.size()){
+            m_table_layouts.resize(table + 1, -1);
+            m_rows_sent.resize(table + 1);
+        }
+        // a relaid out table renumbers its rows, even under a revision already sent
+        if(m_table_layouts[table] != (int64_t)__t.generation){
+            m_table_layouts[table] = __t.generation;
+            m_rows_sent[table].clear();
+            __w.put<uint8_t>(DELTA_TABLE);
+            __w.put<uint32_t>(table);
+            __w.put<uint32_t>(__t.ns);
+            __w.put<uint32_t>(__t.id);
+            __w.put<uint32_t>(__t.revision);
+            __w.put<uint16_t>((uint16_t)__t.width());
+            for(size_t i = 0; i < __t.width(); i++){
+                __w.put_string(__t.names[i]);
+            }
+            m_records++;
+        }
+        std::vector<uint8_t>& __sent = m_rows_sent[table];
+        if((size_t)row >= __sent.size()){
+            __sent.resize(row + 1, 0);
+        }
+        const double* __values = __t.width() ? &__t.values[row * __t.width()] : 0;
+        if(!__sent[row]){
+            __sent[row] = 1;
+            __w.put<uint8_t>(DELTA_ROW);
+            __w.put<uint32_t>(table);
+            __w.put<uint32_t>(row);
+            __w.put<int32_t>(__t.granularities[row]);
+            __w.put_string(__t.markets[row]);
+            __w.put_string(__t.stock_codes[row]);
+            __w.put<int64_t>(__t.time_tags[row]);
+            for(size_t i = 0; i < __t.width(); i++){
+                __w.put<double>(__values[i]);
+            }
+        }else{
+            const uint8_t* __mask = __t.width() ? &__t.masks[row * __t.mask_bytes()] : 0;
+            __w.put<uint8_t>(DELTA_CHANGE);
+            __w.put<uint32_t>(table);
+            __w.put<uint32_t>(row);
+            __w.put<int64_t>(__t.time_tags[row]);
+            __w.put_bytes(__mask, __t.mask_bytes());
+            for(size_t i = 0; i < __t.width(); i++){
+                if(__mask[i >> 3] & (1 << (i & 7))){
+                    __w.put<double>(__values[i]);
+                }
+            }
+        }
+        m_records++;
+    }
+
+    ByteArray m_out;
+    uint32_t m_records;
+    std::vector<int64_t> m_table_layouts;
+    std::vector<std::vector<uint8_t> > m_rows_sent;
+};
+
+/*
+ * Client side of the delta stream: mirrors the snapshot and turns every
+ * update into {namespace, metaID, market, code, granularity, timeTag, fields}
+ * where fields holds the values carried by the record (all of them for ROW,
+ * only the changed ones for DELTA).
+ */
+class _snapshot_delta_decoder {
+public:
+    _snapshot_delta_decoder() {}
+
+    // array of updates, null when the buffer is malformed or refers to unknown rows
+    emscripten::val decode(emscripten::val bytes) {
+        size_t __n = bytes["length"].as<size_t>();
+        m_in.resize(__n);
+        if(__n){
+            emscripten::val(emscripten::typed_memory_view(__n, m_in.data())).call<void>("set", bytes);
+        }
+        _delta_reader __r(m_in.data(), m_in.size());
+        if(__r.get<uint8_t>() != 'S' || __r.get<uint8_t>() != 'D' || __r.get<uint8_t>() != __DELTA_VERSION){
+            return emscripten::val::null();
+        }
+        __r.get<uint8_t>();
+        uint32_t __records = __r.get<uint32_t>();
+        emscripten::val __ret = emscripten::val::array();
+        size_t __out = 0;
+        for(uint32_t i = 0; i < __records && __r.ok(); i++){
+            uint8_t __kind = __r.get<uint8_t>();
+            if(__kind == DELTA_TABLE){
+                read_table(__r);
+            }else if(__kind == DELTA_ROW || __kind == DELTA_CHANGE){
+                emscripten::val __update = read_row(__r, __kind == DELTA_ROW);
+                if(__update.isNull()){
+                    return __update;
+                }
+                __ret.set(__out++, __update);
+            }else{
+                return emscripten::val::null();
+            }
+        }
+        return __r.ok() ? __ret : emscripten::val::null();
+    }
+    // all fields of a mirrored row, null if unknown
+    emscripten::val row(uint32_t table, uint32_t row) const {
+        std::map<uint32_t, _table>::const_iterator it = m_tables.find(table);
+        if(it == m_tables.end() || row >= it->second.rows.size() || !it->second.rows[row].known){
+            return emscripten::val::null();
+        }
+        return to_js(it->second, it->second.rows[row], 0);
+    }
+    void reset() {
+        m_tables.clear();
+    }
+private:
+    struct _row {
+        bool known;
+        int32_t granularity;
+        int64_t time_tag;
+        std::string market;
+        std::string code;
+        std::vector<double> values;
+        _row():known(false), granularity(0), time_tag(0) {}
+    };
+    struct _table {
+        uint32_t ns;
+        uint32_t id;
+        uint32_t revision;
+        std::vector<std::string> names;
+        std::vector<_row> rows;
+    };
+
+    void read_table(_delta_reader& r) {
+        uint32_t __id = r.get<uint32_t>();
+        _table& __t = m_tables[__id];
+        __t.ns = r.get<uint32_t>();
+        __t.id = r.get<uint32_t>();
+        __t.revision = r.get<uint32_t>();
+        uint16_t __width = r.get<uint16_t>();
+        __t.names.clear();
+        __t.rows.clear();
+        for(uint16_t i = 0; i < __width && r.ok(); i++){
+            __t.names.push_back(r.get_string());
+        }
+    }
+
+    emscripten::val read_row(_delta_reader& r, bool full) {
+        uint32_t __table = r.get<uint32_t>();
+        uint32_t __row = r.get<uint32_t>();
+        std::map<uint32_t, _table>::iterator it = m_tables.find(__table);
+        if(it == m_tables.end() || !r.ok()){
+            return emscripten::val::null();
+        }
+        _table& __t = it->second;
+        size_t __width = __t.names.size();
+        if(__row >= __t.rows.size()){
+            __t.rows.resize(__row + 1);
+        }
+        _row& __r = __t.rows[__row];
+        if(full){
+            __r.known = true;
+            __r.granularity = r.get<int32_t>();
+            __r.market = r.get_string();
+            __r.code = r.get_string();
+            __r.time_tag = r.get<int64_t>();
+            __r.values.resize(__width);
+            for(size_t i = 0; i < __width; i++){
+                __r.values[i] = r.get<double>();
+            }
+            return r.ok() ? to_js(__t, __r, 0) : emscripten::val::null();
+        }
+        if(!__r.known){
+            return emscripten::val::null();
+        }
+        __r.time_tag = r.get<int64_t>();
+        const uint8_t* __mask = r.get_bytes((__width + 7) / 8);
+        if(!__mask){
+            return emscripten::val::null();
+        }
+        for(size_t i = 0; i < __width; i++){
+            if(__mask[i >> 3] & (1 << (i & 7))){
+                __r.values[i] = r.get<double>();
+            }
+        }
+        return r.ok() ? to_js(__t, __r, __mask) : emscripten::val::null();
+    }
+
+    // mask null exports every field
+    static emscripten::val to_js(const _table& t, const _row& r, const uint8_t* mask) {
+        emscripten::val __ret = emscripten::val::object();
+        emscripten::val __fields = emscripten::val::object();
+        __ret.set("namespace", t.ns);
+        __ret.set("metaID", t.id);
+        __ret.set("market", r.market);
+        __ret.set("code", r.code);
+        __ret.set("granularity", r.granularity);
+        __ret.set("timeTag", r.time_tag);
+        for(size_t i = 0; i < t.names.size(); i++){
+            if(!mask || (mask[i >> 3] & (1 << (i & 7)))){
+                __fields.set(t.names[i], r.values[i]);
+            }
+        }
+        __ret.set("fields", __fields);
+        return __ret;
+    }
+
+    ByteArray m_in;
+    std::map<uint32_t, _table> m_tables;
+};
+
+#endif
@@ -0,0 +1,341 @@
+#ifndef __CAITLYN_JS_FORMULA_HPP__
+#define __CAITLYN_JS_FORMULA_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_columns.hpp>
+
+static_assert(sizeof(double_t) == sizeof(double), "FormulaChart double series are exported as Float64Array");
+
+/*
+ * Series i of a chart as a typed array. When the chart hands out a reference
+ * to its storage the array is a view over WASM memory, valid while the
+ * FormulaChart lives and until memory grows; a returned copy goes into a JS
+ * owned array instead, one copy rather than one get(i) call per bar.
+ */
+template<typename T>
+emscripten::val __chart_series_array(_formula_chart& chart, int32_t i, const char* ctor) {
+    typedef decltype(chart.get<T>(i)) __result;
+    if(std::is_lvalue_reference<__result>::value){
+        const std::vector<T>& __series = chart.get<T>(i);
+        return emscripten::val(emscripten::typed_memory_view(__series.size(), __series.data()));
+    }
+    std::vector<T> __series = chart.get<T>(i);
+    return __to_typed_array(__series, ctor);
+}
+
+// booleans always land in a JS owned Uint8Array of 0/1, whatever the chart stores them as
+inline emscripten::val __chart_bool_array(_formula_chart& chart, int32_t i) {
+    const auto& __bits = chart.getbool(i);
+    std::vector<uint8_t> __bytes(__bits.size());
+    for(size_t k = 0; k < __bits.size(); k++){
+        __bytes[k] = __bits[k] ? 1 : 0;
+    }
+    return __to_typed_array(__bytes, "Uint8Array");
+}
+
+// FormulaChart.seriesView(i): Float64Array, Int32Array, Uint8Array or an array of strings; null for other variables
+inline emscripten::val _formula_chart_series_view(_formula_chart& chart, int32_t i) {
+    if(i < 0 || i >= (int32_t)chart.variable_types_.size()){
+        return emscripten::val::null();
+    }
+    switch(chart.variable_types_[i]){
+    case _formula_variable_type::tDouble:
+        return __chart_series_array<double_t>(chart, i, "Float64Array");
+    case _formula_variable_type::tInteger:
+        return __chart_series_array<int32_t>(chart, i, "Int32Array");
+    case _formula_variable_type::tBoolean:
+        return __chart_bool_array(chart, i);
+    case _formula_variable_type::tString:
+        return __to_string_array(chart.get<std::string>(i));
+    default:
+        return emscripten::val::null();
+    }
+}
+
+inline bool __is_numeric_series(_formula_variable_type type) {
+    return type == _formula_variable_type::tDouble || type == _formula_variable_type::tInteger || type == _formula_variable_type::tBoolean;
+}
+
+// calls fn(series) with numeric series v of the chart, whatever its element type
+template<typename F>
+void __with_numeric_series(_formula_chart& chart, size_t v, F fn) {
+    _formula_variable_type __type = chart.variable_types_[v];
+    if(__type == _formula_variable_type::tDouble){
+        fn(chart.get<double_t>((int32_t)v));
+    }else if(__type == _formula_variable_type::tInteger){
+        fn(chart.get<int32_t>((int32_t)v));
+    }else if(__type == _formula_variable_type::tBoolean){
+        fn(chart.getbool((int32_t)v));
+    }
+}
+
+/*
+ * ATCalFormulaRes.packColumns(): every numeric series of every chart in one
+ * Float64Array, series after series, count = timeTags.length values each.
+ *   {count, timeTags: BigInt64Array, values: Float64Array,
+ *    series: [{chart, variable, name, type, offset, length}]}
+ * Integers and booleans (0/1) are widened to double; rows past a series'
+ * own length are NaN. String series are left out.
+ */
+inline emscripten::val _cal_formula_res_pack_columns(_at_cal_formula_res& res) {
+    std::vector<int64_t> __time_tags(res.time_tags_.begin(), res.time_tags_.end());
+    size_t __count = __time_tags.size();
+    emscripten::val __series = emscripten::val::array();
+
+    // one pass to size the buffer, then fill it in place
+    size_t __total = 0;
+    for(size_t c = 0; c < res.charts_.size(); c++){
+        const std::vector<_formula_variable_type>& __types = res.charts_[c].variable_types_;
+        __total += std::count_if(__types.begin(), __types.end(), __is_numeric_series);
+    }
+    std::vector<double> __values(__total * __count, std::numeric_limits<double>::quiet_NaN());
+
+    size_t __index = 0;
+    for(size_t c = 0; c < res.charts_.size(); c++){
+        _formula_chart& __chart = res.charts_[c];
+        for(size_t v = 0; v < __chart.variable_types_.size(); v++){
+            if(!__is_numeric_series(__chart.variable_types_[v])){
+                continue;
+            }
+            double* __out = __values.empty() ? 0 : &__values[__index * __count];
+            size_t __length = 0;
+            __with_numeric_series(__chart, v, [&](const auto& series){
+                size_t __n = std::min((size_t)series.size(), __count);
+                for(size_t k = 0; k < __n; k++){
+                    __out[k] = (double)series[k];
+                }
+                __length = series.size();
+            });
+            emscripten::val __info = emscripten::val::object();
+            __info.set("chart", c);
+            __info.set("variable", v);
+            __info.set("name", __chart.name_);
+            __info.set("type", __chart.variable_types_[v]);
+            __info.set("offset", __index * __count);
+            __info.set("length", __length);
+            __series.call<void>("push", __info);
+            __index++;
+        }
+    }
+
+    emscripten::val __ret = emscripten::val::object();
+    __ret.set("count", __count);
+    __ret.set("timeTags", __to_typed_array(__time_tags, "BigInt64Array"));
+    __ret.set("values", __to_typed_array(__values, "Float64Array"));
+    __ret.set("series", __series);
+    return __ret;
+}
+
+
+struct _formula_series_info {
+    int32_t chart;
+    int32_t variable;
+    std::string name;
+    _formula_variable_type type;
+};
+
+// merged bars of one formula UUID; rows [begin, time_tags.size()) are live
+struct _formula_series_state {
+    std::vector<_formula_series_info> info;
+    std::map<std::pair<int32_t, int32_t>, size_t> index;    // (chart, variable) -> series
+    std::vector<int64_t> time_tags;
+    std::vector<std::vector<double> > values;
+    size_t begin;
+
+    _formula_series_state():begin(0) {}
+    size_t count() const {
+        return time_tags.size() - begin;
+    }
+};
+
+/*
+ * Resident formula results, one per UUID. load() takes the full history of
+ * an ATCalFormulaRes, merge() applies an ATCalFormulaRTRes push: each of its
+ * bars overwrites the bar with the same time tag or is inserted in time
+ * order, usually appended. Series are matched by (chart, variable); rows a
+ * push does not carry keep their values, new rows of missing series are NaN.
+ * String series are not kept.
+ *
+ * timeTags()/series() are views over the store, valid until the next load(),
+ * merge() or remove() and until WASM memory grows. With a capacity only the
+ * newest capacity bars stay live: rows before them are dropped in one move
+ * once they fill another capacity, so memory stays under 2 * capacity bars
+ * and the live rows stay contiguous for the views.
+ */
+class _formula_series_store {
+public:
+    _formula_series_store(size_t capacity):m_capacity(capacity) {}
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+    // replaces the state of res.uuid with its full result
+    void load(_at_cal_formula_res& res) {
+        _formula_series_state& __state = m_states[res.uuid];
+        __state = _formula_series_state();
+        layout(__state, res.charts_);
+        __state.time_tags.assign(res.time_tags_.begin(), res.time_tags_.end());
+        size_t __count = __state.time_tags.size();
+        for(size_t s = 0; s < __state.info.size(); s++){
+            std::vector<double>& __column = __state.values[s];
+            __column.assign(__count, std::numeric_limits<double>::quiet_NaN());
+            __with_numeric_series(res.charts_[__state.info[s].chart], __state.info[s].variable, [&](const auto& series){
+                size_t __n = std::min((size_t)series.size(), __count);
+                for(size_t k = 0; k < __n; k++){
+                    __column[k] = (double)series[k];
+                }
+            });
+        }
+        trim(__state);
+    }
+    // number of bars written; a UUID without load() starts from the push's charts
+    size_t merge(_at_cal_formula_rt_res& res) {
+        _formula_series_state& __state = m_states[res.uuid_];
+        if(__state.info.empty()){
+            layout(__state, res.charts_);
+        }
+        std::vector<int64_t> __tags(res.time_tags_.begin(), res.time_tags_.end());
+        std::vector<size_t> __rows(__tags.size());
+        size_t __written = 0;
+        for(size_t k = 0; k < __tags.size(); k++){
+            std::vector<int64_t>::iterator __live = __state.time_tags.begin() + __state.begin;
+            std::vector<int64_t>::iterator it = std::lower_bound(__live, __state.time_tags.end(), __tags[k]);
+            size_t __row = it - __state.time_tags.begin();
+            __rows[k] = __row;
+            if(it != __state.time_tags.end() && *it == __tags[k]){
+                __written++;
+                continue;
+            }
+            if(it == __live && __state.count() > 0 && m_capacity && __state.count() >= m_capacity){
+                // older than every live bar of a full ring
+                __rows[k] = (size_t)-1;
+                continue;
+            }
+            __state.time_tags.insert(it, __tags[k]);
+            for(size_t s = 0; s < __state.values.size(); s++){
+                __state.values[s].insert(__state.values[s].begin() + __row, std::numeric_limits<double>::quiet_NaN());
+            }
+            for(size_t j = 0; j < k; j++){
+                if(__rows[j] != (size_t)-1 && __rows[j] >= __row) __rows[j]++;
+            }
+            __written++;
+        }
+        for(size_t c = 0; c < res.charts_.size(); c++){
+            _formula_chart& __chart = res.charts_[c];
+            for(size_t v = 0; v < __chart.variable_types_.size(); v++){
+                std::map<std::pair<int32_t, int32_t>, size_t>::iterator it = __state.index.find(std::make_pair((int32_t)c, (int32_t)v));
+                if(it == __state.index.end() || !__is_numeric_series(__chart.variable_types_[v])){
+                    continue;
+                }
+                std::vector<double>& __column = __state.values[it->second];
+                __with_numeric_series(__chart, v, [&](const auto& series){
+                    size_t __n = std::min((size_t)series.size(), __rows.size());
+                    for(size_t k = 0; k < __n; k++){
+                        if(__rows[k] != (size_t)-1) __column[__rows[k]] = (double)series[k];
+                    }
+                });
+            }
+        }
+        trim(__state);
+        return __written;
+    }
+    bool remove(const std::string& uuid) {
+        return m_states.erase(uuid) > 0;
+    }
+    bool has(const std::string& uuid) const {
+        return m_states.find(uuid) != m_states.end();
+    }
+    emscripten::val uuids() const {
+        emscripten::val __ret = emscripten::val::array();
+        for(std::map<std::string, _formula_series_state>::const_iterator it = m_states.begin(); it != m_states.end(); ++it){
+            __ret.call<void>("push", it->first);
+        }
+        return __ret;
+    }
+    size_t count(const std::string& uuid) const {
+        const _formula_series_state* __state = find(uuid);
+        return __state ? __state->count() : 0;
+    }
+    // [{chart, variable, name, type}], index i is series(uuid, i); null for an unknown UUID
+    emscripten::val series_info(const std::string& uuid) const {
+        const _formula_series_state* __state = find(uuid);
+        if(!__state){
+            return emscripten::val::null();
+        }
+        emscripten::val __ret = emscripten::val::array();
+        for(size_t s = 0; s < __state->info.size(); s++){
+            emscripten::val __info = emscripten::val::object();
+            __info.set("chart", __state->info[s].chart);
+            __info.set("variable", __state->info[s].variable);
+            __info.set("name", __state->info[s].name);
+            __info.set("type", __state->info[s].type);
+            __ret.call<void>("push", __info);
+        }
+        return __ret;
+    }
+    // BigInt64Array view of the live time tags
+    emscripten::val time_tags(const std::string& uuid) const {
+        const _formula_series_state* __state = find(uuid);
+        if(!__state){
+            return emscripten::val::null();
+        }
+        return emscripten::val(emscripten::typed_memory_view(__state->count(), __state->time_tags.data() + __state->begin));
+    }
+    // Float64Array view of the live rows of series i
+    emscripten::val series(const std::string& uuid, size_t i) const {
+        const _formula_series_state* __state = find(uuid);
+        if(!__state || i >= __state->values.size()){
+            return emscripten::val::null();
+        }
+        return emscripten::val(emscripten::typed_memory_view(__state->count(), __state->values[i].data() + __state->begin));
+    }
+private:
+    const _formula_series_state* find(const std::string& uuid) const {
+        std::map<std::string, _formula_series_state>::const_iterator it = m_states.find(uuid);
+        return it == m_states.end() ? 0 : &it->second;
+    }
+    static void layout(_formula_series_state& state, std::vector<_formula_chart>& charts) {
+        for(size_t c = 0; c < charts.size(); c++){
+            for(size_t v = 0; v < charts[c].variable_types_.size(); v++){
+                if(!__is_numeric_series(charts[c].variable_types_[v])){
+                    continue;
+                }
+                _formula_series_info __info;
+                __info.chart = (int32_t)c;
+                __info.variable = (int32_t)v;
+                __info.name = charts[c].name_;
+                __info.type = charts[c].variable_types_[v];
+                state.index[std::make_pair(__info.chart, __info.variable)] = state.info.size();
+                state.info.push_back(__info);
+            }
+        }
+        state.values.resize(state.info.size());
+    }
+    void trim(_formula_series_state& state) const {
+        if(!m_capacity || state.count() <= m_capacity){
+            return;
+        }
+        state.begin = state.time_tags.size() - m_capacity;
+        if(state.begin >= m_capacity){
+            state.time_tags.erase(state.time_tags.begin(), state.time_tags.begin() + state.begin);
+            for(size_t s = 0; s < state.values.size(); s++){
+                state.values[s].erase(state.values[s].begin(), state.values[s].begin() + state.begin);
+            }
+            state.begin = 0;
+        }
+    }
+
+    size_t m_capacity;
+    std::map<std::string, _formula_series_state> m_states;
+};
+
+#endif
@@ -0,0 +1,485 @@
+#ifndef __CAITLYN_JS_INDICATORS_HPP__
+#define __CAITLYN_JS_INDICATORS_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <emscripten/bind.h>
+#include <caitlyn_js_simd.hpp>
+#include <caitlyn_js_columns.hpp>
+
+/*
+ * Technical indicators as O(1) state machines. Each is bound twice: as a
+ * streaming class (SMAIndicator, ...) whose update() takes one tick, and as a
+ * batch function (sma(values, period), ...) that runs the same state over a
+ * Float64Array column, so both give identical values. Outputs are NaN until
+ * the window is filled; NaN inputs (empty fields) are skipped, they output NaN
+ * and leave the state untouched.
+ */
+
+inline double __indicator_nan() {
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+inline int32_t __indicator_period(int32_t period) {
+    return period < 1 ? 1 : period;
+}
+
+// fixed window of the last period values
+class __indicator_window {
+public:
+    __indicator_window(int32_t period):m_values(__indicator_period(period)), m_head(0), m_count(0) {}
+
+    // pushes x and returns the value it evicted, NaN while filling
+    double push(double x) {
+        double __old = full() ? m_values[m_head] : __indicator_nan();
+        m_values[m_head] = x;
+        m_head = (m_head + 1) % m_values.size();
+        if(!full()) m_count++;
+        return __old;
+    }
+    bool full() const {
+        return m_count == m_values.size();
+    }
+    size_t count() const {
+        return m_count;
+    }
+    size_t period() const {
+        return m_values.size();
+    }
+    void reset() {
+        m_head = 0;
+        m_count = 0;
+    }
+private:
+    std::vector<double> m_values;
+    size_t m_head;
+    size_t m_count;
+};
+
+class _sma_indicator {
+public:
+    _sma_indicator(int32_t period):m_window(period), m_sum(0), m_value(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        double __old = m_window.push(x);
+        m_sum += x - (std::isnan(__old) ? 0 : __old);
+        m_value = m_window.full() ? m_sum / m_window.period() : __indicator_nan();
+        return m_value;
+    }
+    double value() const { return m_value; }
+    bool ready() const { return m_window.full(); }
+    void reset() {
+        m_window.reset();
+        m_sum = 0;
+        m_value = __indicator_nan();
+    }
+private:
+    __indicator_window m_window;
+    double m_sum;
+    double m_value;
+};
+
+// seeded with the first value, alpha = 2 / (period + 1)
+class _ema_indicator {
+public:
+    _ema_indicator(int32_t period):m_alpha(2.0 / (__indicator_period(period) + 1)), m_value(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        m_value = std::isnan(m_value) ? x : m_value + m_alpha * (x - m_value);
+        return m_value;
+    }
+    double value() const { return m_value; }
+    bool ready() const { return !std::isnan(m_value); }
+    void reset() { m_value = __indicator_nan(); }
+private:
+    double m_alpha;
+    double m_value;
+};
+
+// weights 1..period, newest heaviest; the weighted sum moves by period * x - sum
+class _wma_indicator {
+public:
+    _wma_indicator(int32_t period):m_window(period), m_sum(0), m_weighted(0), m_value(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        bool __full = m_window.full();
+        double __old = m_window.push(x);
+        if(__full){
+            m_weighted += m_window.period() * x - m_sum;
+            m_sum += x - __old;
+        }else{
+            m_weighted += m_window.count() * x;
+            m_sum += x;
+        }
+        double __n = (double)m_window.period();
+        m_value = m_window.full() ? m_weighted / (__n * (__n + 1) / 2) : __indicator_nan();
+        return m_value;
+    }
+    double value() const { return m_value; }
+    bool ready() const { return m_window.full(); }
+    void reset() {
+        m_window.reset();
+        m_sum = 0;
+        m_weighted = 0;
+        m_value = __indicator_nan();
+    }
+private:
+    __indicator_window m_window;
+    double m_sum;
+    double m_weighted;
+    double m_value;
+};
+
+// population standard deviation over the window, rolling Welford update
+class _rolling_std_indicator {
+public:
+    _rolling_std_indicator(int32_t period):m_window(period), m_mean(0), m_m2(0), m_value(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        bool __full = m_window.full();
+        double __old = m_window.push(x);
+        if(__full){
+            double __mean = m_mean + (x - __old) / m_window.period();
+            m_m2 += (x - __old) * (x - __mean + __old - m_mean);
+            m_mean = __mean;
+        }else{
+            double __delta = x - m_mean;
+            m_mean += __delta / m_window.count();
+            m_m2 += __delta * (x - m_mean);
+        }
+        m_value = m_window.full() ? std::sqrt(std::max(m_m2, 0.0) / m_window.period()) : __indicator_nan();
+        return m_value;
+    }
+    double mean() const { return m_window.full() ? m_mean : __indicator_nan(); }
+    double value() const { return m_value; }
+    bool ready() const { return m_window.full(); }
+    void reset() {
+        m_window.reset();
+        m_mean = 0;
+        m_m2 = 0;
+        m_value = __indicator_nan();
+    }
+private:
+    __indicator_window m_window;
+    double m_mean;
+    double m_m2;
+    double m_value;
+};
+
+/*
+ * Rolling min (or max with Greater) over the window: a monotonic queue in a
+ * ring of period slots, amortized O(1) per update.
+ */
+template<bool Greater>
+class _rolling_extreme_indicator {
+public:
+    _rolling_extreme_indicator(int32_t period)
+        :m_period(__indicator_period(period)), m_slots(__indicator_period(period)), m_head(0), m_size(0), m_index(0), m_value(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        // drop the front once it leaves the window, then entries x dominates
+        if(m_size > 0 && m_slots[m_head].first + (int64_t)m_period <= m_index){
+            m_head = (m_head + 1) % m_period;
+            m_size--;
+        }
+        while(m_size > 0 && better(x, m_slots[back()].second)){
+            m_size--;
+        }
+        m_slots[(m_head + m_size) % m_period] = std::make_pair(m_index, x);
+        m_size++;
+        m_index++;
+        m_value = m_index >= (int64_t)m_period ? m_slots[m_head].second : __indicator_nan();
+        return m_value;
+    }
+    double value() const { return m_value; }
+    bool ready() const { return m_index >= (int64_t)m_period; }
+    void reset() {
+        m_head = 0;
+        m_size = 0;
+        m_index = 0;
+        m_value = __indicator_nan();
+    }
+private:
+    size_t back() const {
+        return (m_head + m_size - 1) % m_period;
+    }
+    bool better(double a, double b) const {
+        return Greater ? a > b : a < b;
+    }
+
+    size_t m_period;
+    std::vector<std::pair<int64_t, double> > m_slots;
+    size_t m_head;
+    size_t m_size;
+    int64_t m_index;
+    double m_value;
+};
+
+typedef _rolling_extreme_indicator<false> _rolling_min_indicator;
+typedef _rolling_extreme_indicator<true> _rolling_max_indicator;
+
+// Wilder smoothing, alpha = 1 / period, seeded by the first change as in IndicatorExamples.js
+class _rsi_indicator {
+public:
+    _rsi_indicator(int32_t period):m_alpha(1.0 / __indicator_period(period)), m_prev(__indicator_nan()), m_gain(0), m_loss(0), m_changes(0), m_value(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        if(std::isnan(m_prev)){
+            m_prev = x;
+            return m_value;
+        }
+        double __change = x - m_prev;
+        double __gain = __change > 0 ? __change : 0;
+        double __loss = __change < 0 ? -__change : 0;
+        if(m_changes == 0){
+            m_gain = __gain;
+            m_loss = __loss;
+        }else{
+            m_gain += m_alpha * (__gain - m_gain);
+            m_loss += m_alpha * (__loss - m_loss);
+        }
+        m_changes++;
+        m_prev = x;
+        m_value = m_loss != 0 ? 100 - 100 / (1 + m_gain / m_loss) : 100;
+        return m_value;
+    }
+    double value() const { return m_value; }
+    bool ready() const { return m_changes > 0; }
+    void reset() {
+        m_prev = __indicator_nan();
+        m_gain = 0;
+        m_loss = 0;
+        m_changes = 0;
+        m_value = __indicator_nan();
+    }
+private:
+    double m_alpha;
+    double m_prev;
+    double m_gain;
+    double m_loss;
+    int64_t m_changes;
+    double m_value;
+};
+
+// update() returns the MACD line; signal is the EMA of the line, seeded with its first value
+class _macd_indicator {
+public:
+    _macd_indicator(int32_t fast, int32_t slow, int32_t signal)
+        :m_fast(fast), m_slow(slow), m_signal(signal), m_macd(__indicator_nan()) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        m_macd = m_fast.update(x) - m_slow.update(x);
+        m_signal.update(m_macd);
+        return m_macd;
+    }
+    double macd() const { return m_macd; }
+    double signal() const { return m_signal.value(); }
+    double histogram() const { return m_macd - m_signal.value(); }
+    bool ready() const { return m_signal.ready(); }
+    void reset() {
+        m_fast.reset();
+        m_slow.reset();
+        m_signal.reset();
+        m_macd = __indicator_nan();
+    }
+private:
+    _ema_indicator m_fast;
+    _ema_indicator m_slow;
+    _ema_indicator m_signal;
+    double m_macd;
+};
+
+// middle = SMA, bands at k population standard deviations; update() returns the middle
+class _bollinger_indicator {
+public:
+    _bollinger_indicator(int32_t period, double k):m_std(period), m_k(k) {}
+
+    double update(double x) {
+        if(std::isnan(x)) return __indicator_nan();
+        m_std.update(x);
+        return middle();
+    }
+    double middle() const { return m_std.mean(); }
+    double deviation() const { return m_std.value(); }
+    double upper() const { return middle() + m_k * deviation(); }
+    double lower() const { return middle() - m_k * deviation(); }
+    bool ready() const { return m_std.ready(); }
+    void reset() { m_std.reset(); }
+private:
+    _rolling_std_indicator m_std;
+    double m_k;
+};
+
+// Wilder ATR: mean of the first period true ranges, then (atr * (period - 1) + tr) / period
+class _atr_indicator {
+public:
+    _atr_indicator(int32_t period):m_period(__indicator_period(period)), m_prev_close(__indicator_nan()), m_count(0), m_sum(0), m_value(__indicator_nan()) {}
+
+    double update(double high, double low, double close) {
+        if(std::isnan(high) || std::isnan(low) || std::isnan(close)) return __indicator_nan();
+        double __tr = high - low;
+        if(!std::isnan(m_prev_close)){
+            __tr = std::max(__tr, std::max(std::fabs(high - m_prev_close), std::fabs(low - m_prev_close)));
+        }
+        m_prev_close = close;
+        m_count++;
+        if(m_count < m_period){
+            m_sum += __tr;
+        }else if(m_count == m_period){
+            m_value = (m_sum + __tr) / m_period;
+        }else{
+            m_value = (m_value * (m_period - 1) + __tr) / m_period;
+        }
+        return m_value;
+    }
+    double value() const { return m_value; }
+    bool ready() const { return m_count >= m_period; }
+    void reset() {
+        m_prev_close = __indicator_nan();
+        m_count = 0;
+        m_sum = 0;
+        m_value = __indicator_nan();
+    }
+private:
+    int32_t m_period;
+    double m_prev_close;
+    int32_t m_count;
+    double m_sum;
+    double m_value;
+};
+
+// cumulative volume weighted price since construction or the last reset(), e.g. per session
+class _vwap_indicator {
+public:
+    _vwap_indicator():m_pv(0), m_volume(0) {}
+
+    double update(double price, double volume) {
+        if(std::isnan(price) || std::isnan(volume)) return __indicator_nan();
+        m_pv += price * volume;
+        m_volume += volume;
+        return value();
+    }
+    double value() const { return m_volume != 0 ? m_pv / m_volume : __indicator_nan(); }
+    bool ready() const { return m_volume != 0; }
+    void reset() {
+        m_pv = 0;
+        m_volume = 0;
+    }
+private:
+    double m_pv;
+    double m_volume;
+};
+
+// batch functions: one pass of the streaming state over Float64Array columns
+
+template<typename I>
+emscripten::val __run_indicator(I indicator, emscripten::val values) {
+    std::vector<double> __in = emscripten::convertJSArrayToNumberVector<double>(values);
+    std::vector<double> __out(__in.size());
+    for(size_t i = 0; i < __in.size(); i++){
+        __out[i] = indicator.update(__in[i]);
+    }
+    return __to_typed_array(__out, "Float64Array");
+}
+
+inline emscripten::val _indicator_sma(emscripten::val values, int32_t period) {
+    return __run_indicator(_sma_indicator(period), values);
+}
+inline emscripten::val _indicator_ema(emscripten::val values, int32_t period) {
+    return __run_indicator(_ema_indicator(period), values);
+}
+inline emscripten::val _indicator_wma(emscripten::val values, int32_t period) {
+    return __run_indicator(_wma_indicator(period), values);
+}
+inline emscripten::val _indicator_rsi(emscripten::val values, int32_t period) {
+    return __run_indicator(_rsi_indicator(period), values);
+}
+inline emscripten::val _indicator_rolling_std(emscripten::val values, int32_t period) {
+    return __run_indicator(_rolling_std_indicator(period), values);
+}
+inline emscripten::val _indicator_rolling_min(emscripten::val values, int32_t period) {
+    return __run_indicator(_rolling_min_indicator(period), values);
+}
+inline emscripten::val _indicator_rolling_max(emscripten::val values, int32_t period) {
+    return __run_indicator(_rolling_max_indicator(period), values);
+}
+
+// {macd, signal, histogram}
+inline emscripten::val _indicator_macd(emscripten::val values, int32_t fast, int32_t slow, int32_t signal) {
+    std::vector<double> __in = emscripten::convertJSArrayToNumberVector<double>(values);
+    std::vector<double> __macd(__in.size()), __signal(__in.size()), __histogram(__in.size());
+    _macd_indicator __indicator(fast, slow, signal);
+    for(size_t i = 0; i < __in.size(); i++){
+        __macd[i] = __indicator.update(__in[i]);
+        __signal[i] = std::isnan(__in[i]) ? __indicator_nan() : __indicator.signal();
+    }
+    if(!__in.empty()){
+        __f64_sub(&__macd[0], &__signal[0], &__histogram[0], __in.size());
+    }
+    emscripten::val __ret = emscripten::val::object();
+    __ret.set("macd", __to_typed_array(__macd, "Float64Array"));
+    __ret.set("signal", __to_typed_array(__signal, "Float64Array"));
+    __ret.set("histogram", __to_typed_array(__histogram, "Float64Array"));
+    return __ret;
+}
+
+// {middle, upper, lower}
+inline emscripten::val _indicator_bollinger(emscripten::val values, int32_t period, double k) {
+    std::vector<double> __in = emscripten::convertJSArrayToNumberVector<double>(values);
+    std::vector<double> __middle(__in.size()), __deviation(__in.size()), __upper(__in.size()), __lower(__in.size());
+    _rolling_std_indicator __std(period);
+    for(size_t i = 0; i < __in.size(); i++){
+        __deviation[i] = __std.update(__in[i]);
+        __middle[i] = std::isnan(__in[i]) ? __indicator_nan() : __std.mean();
+    }
+    if(!__in.empty()){
+        __f64_band(&__middle[0], &__deviation[0], k, &__upper[0], &__lower[0], __in.size());
+    }
+    emscripten::val __ret = emscripten::val::object();
+    __ret.set("middle", __to_typed_array(__middle, "Float64Array"));
+    __ret.set("upper", __to_typed_array(__upper, "Float64Array"));
+    __ret.set("lower", __to_typed_array(__lower, "Float64Array"));
+    return __ret;
+}
+
+// null when the columns differ in length
+inline emscripten::val _indicator_atr(emscripten::val high, emscripten::val low, emscripten::val close, int32_t period) {
+    std::vector<double> __high = emscripten::convertJSArrayToNumberVector<double>(high);
+    std::vector<double> __low = emscripten::convertJSArrayToNumberVector<double>(low);
+    std::vector<double> __close = emscripten::convertJSArrayToNumberVector<double>(close);
+    if(__high.size() != __low.size() || __high.size() != __close.size()){
+        return emscripten::val::null();
+    }
+    std::vector<double> __out(__close.size());
+    _atr_indicator __indicator(period);
+    for(size_t i = 0; i < __close.size(); i++){
+        __out[i] = __indicator.update(__high[i], __low[i], __close[i]);
+    }
+    return __to_typed_array(__out, "Float64Array");
+}
+
+// cumulative over the whole column; null when the columns differ in length
+inline emscripten::val _indicator_vwap(emscripten::val price, emscripten::val volume) {
+    std::vector<double> __price = emscripten::convertJSArrayToNumberVector<double>(price);
+    std::vector<double> __volume = emscripten::convertJSArrayToNumberVector<double>(volume);
+    if(__price.size() != __volume.size()){
+        return emscripten::val::null();
+    }
+    std::vector<double> __out(__price.size());
+    _vwap_indicator __indicator;
+    for(size_t i = 0; i < __price.size(); i++){
+        __out[i] = __indicator.update(__price[i], __volume[i]);
+    }
+    return __to_typed_array(__out, "Float64Array");
+}
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef __CAITLYN_JS_JSON_HPP__
+#define __CAITLYN_JS_JSON_HPP__
+
+#include <charconv>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_meta.hpp>
+
+inline void __json_append_string(std::string& out, const std::string& s) {
+    static const char __hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for(size_t i = 0; i < s.size(); i++){
+        unsigned char c = (unsigned char)s[i];
+        switch(c){
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if(c < 0x20){
+                out.append("\\u00");
+                out.push_back(__hex[c >> 4]);
+                out.push_back(__hex[c & 0xf]);
+            }else{
+                out.push_back((char)c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+// shortest round-trip form, non-finite values become null
+inline void __json_append_double(std::string& out, double v) {
+    if(!std::isfinite(v)){
+        out.append("null");
+        return;
+    }
+    char __buf[32];
+    std::to_chars_result __r = std::to_chars(__buf, __buf + sizeof(__buf), v);
+    out.append(__buf, __r.ptr);
+}
+
+template<typename T>
+inline void __json_append_int(std::string& out, T v) {
+    char __buf[24];
+    std::to_chars_result __r = std::to_chars(__buf, __buf + sizeof(__buf), v);
+    out.append(__buf, __r.ptr);
+}
+
+template<typename T, typename F>
+inline void __json_append_array(std::string& out, const std::vector<T>& v, F append) {
+    out.push_back('[');
+    for(size_t i = 0; i < v.size(); i++){
+        if(i) out.push_back(',');
+        append(out, v[i]);
+    }
+    out.push_back(']');
+}
+
+/*
+ * Schema aware JSON / NDJSON writer for decoded StructValues.
+ * Records are written straight into a reusable byte buffer as
+ * {"namespace","metaID","market","code","timeTag","granularity","fields":{..}}
+ * in a JSON array, or one record per line in NDJSON mode. Fields are limited
+ * to the projection when one is set; empty fields are written as null.
+ * Each record is written with the meta revision it was encoded with, taken
+ * from setSchema() when given, else from the loaded schema; records of a
+ * revision neither holds are skipped.
+ * "namespace" is the record's own: the label of NAMESPACE_GLOBAL (0) or
+ * NAMESPACE_PRIVATE (1), the number for any other namespace.
+ */
+class _sv_json_writer {
+public:
+    _sv_json_writer():m_ndjson(false), m_tag(0) {
+        m_namespace_labels[0] = "global";
+        m_namespace_labels[1] = "private";
+    }
+
+    void set_schema(boost::shared_ptr<_index_schema> schema) {
+        m_metas.clear();
+        m_layouts.clear();
+        std::vector<_index_meta> __metas = _get_index_schema_metas(*schema);
+        for(size_t i = 0; i < __metas.size(); i++){
+            m_metas[_plan_key(_meta_key((uint32_t)__metas[i].namespace_, (uint32_t)__metas[i].id_), (uint32_t)__metas[i].revision_)] = __metas[i];
+        }
+    }
+    // empty projection writes every field
+    void set_projection(emscripten::val field_names) {
+        m_projection = _make_field_projection(field_names);
+        m_layouts.clear();
+    }
+    // labels written for namespaces 0 and 1
+    void set_namespace_labels(const std::string& global, const std::string& priv) {
+        m_namespace_labels[0] = global;
+        m_namespace_labels[1] = priv;
+    }
+    void set_ndjson(bool ndjson) {
+        m_ndjson = ndjson;
+    }
+
+    size_t write_fetch(_at_fetch_sv_res& res) {
+        return write(_get_sv_res(res));
+    }
+    size_t write_subscribe(_at_subscribe_sv_res& res) {
+        return write(_get_sub_sv_values(res));
+    }
+    size_t write_seeds(_at_universe_seeds_res& res) {
+        return write(_get_seed_data(res));
+    }
+    // view over the written bytes, valid until the next write
+    emscripten::val buffer() {
+        return emscripten::val(emscripten::typed_memory_view(m_out.size(), (const uint8_t*)m_out.data()));
+    }
+    std::string text() const {
+        return m_out;
+    }
+    size_t size() const {
+        return m_out.size();
+    }
+    size_t capacity() const {
+        return m_out.capacity();
+    }
+    void clear() {
+        m_out.clear();
+    }
+private:
+    struct _field_ref {
+        int32_t pos;
+        _data_type type;
+        std::string key;
+    };
+    typedef std::vector<_field_ref> _layout;
+
+    size_t write(const std::vector<_sv_ptr>& rows) {
+        m_out.clear();
+        if(!m_ndjson){
+            m_out.push_back('[');
+        }
+        size_t __written = 0;
+        for(size_t i = 0; i < rows.size(); i++){
+            const _layout* __layout = layout(*rows[i]);
+            if(!__layout){
+                continue;
+            }
+            if(__written && !m_ndjson){
+                m_out.push_back(',');
+            }
+            write_record(*rows[i], *__layout);
+            if(m_ndjson){
+                m_out.push_back('\n');
+            }
+            __written++;
+        }
+        if(!m_ndjson){
+            m_out.push_back(']');
+        }
+        return __written;
+    }
+
+    // the record's revision of its meta; image holds the directory image it lives in
+    const _index_meta* find_meta(const _plan_key& key, _schema_image_ptr& image) const {
+        if(m_metas.empty()){
+            image = _meta_directory::instance().image();
+            return image->find(key.first.first, key.first.second, key.second);
+        }
+        std::map<_plan_key, _index_meta>::const_iterator it = m_metas.find(key);
+        return it == m_metas.end() ? 0 : &it->second;
+    }
+
+    // projected fields of the record's meta revision, resolved once per revision
+    const _layout* layout(_sv& sv) {
+        _plan_key __key(_meta_key((uint32_t)sv.getNamespace(), (uint32_t)sv.getMetaID()), (uint32_t)sv.getRevision());
+        // a directory update may replace a revision in place
+        if(m_metas.empty() && m_tag != _meta_directory::instance().tag()){
+            m_layouts.clear();
+            m_tag = _meta_directory::instance().tag();
+        }
+        std::map<_plan_key, _layout>::iterator it = m_layouts.find(__key);
+        if(it != m_layouts.end()){
+            return &it->second;
+        }
+        _schema_image_ptr __image;
+        const _index_meta* __meta = find_meta(__key, __image);
+        if(!__meta){
+            return 0;
+        }
+        _layout& __layout = m_layouts[__key];
+        const std::vector<int32_t>& __positions = m_projection.positions(*__meta);
+        for(size_t i = 0; i < __positions.size(); i++){
+            const _index_field& __field = __meta->fields_[__positions[i]];
+            _field_ref __ref;
+            __ref.pos = __positions[i];
+            __ref.type = __field.type_;
+            __ref.key.clear();
+            __json_append_string(__ref.key, __field.name_);
+            __ref.key.push_back(':');
+            __layout.push_back(__ref);
+        }
+        return &__layout;
+    }
+
+    void write_record(_sv& sv, const _layout& layout) {
+        uint32_t __ns = (uint32_t)sv.getNamespace();
+        m_out.append("{\"namespace\":");
+        if(__ns < 2){
+            __json_append_string(m_out, m_namespace_labels[__ns]);
+        }else{
+            __json_append_int(m_out, __ns);
+        }
+        m_out.append(",\"metaID\":");
+        __json_append_int(m_out, (uint32_t)sv.getMetaID());
+        m_out.append(",\"market\":");
+        __json_append_string(m_out, sv.getMarket());
+        m_out.append(",\"code\":");
+        __json_append_string(m_out, sv.getStockCode());
+        // time tags exceed 2^53 in some feeds, keep them as strings like timeTag in JS
+        m_out.append(",\"timeTag\":\"");
+        __json_append_int(m_out, (uint64_t)sv.getTimeTag());
+        m_out.append("\",\"granularity\":");
+        __json_append_int(m_out, (uint32_t)sv.getGranularity());
+        m_out.append(",\"fields\":{");
+        for(size_t i = 0; i < layout.size(); i++){
+            if(i) m_out.push_back(',');
+            m_out.append(layout[i].key);
+            write_field(sv, layout[i]);
+        }
+        m_out.append("}}");
+    }
+
+    void write_field(_sv& sv, const _field_ref& f) {
+        if(f.pos >= (int32_t)sv.size() || sv.isEmpty(f.pos)){
+            m_out.append("null");
+            return;
+        }
+        switch(f.type){
+        case _data_type::INT:
+            __json_append_int(m_out, sv.getInt(f.pos));
+            break;
+        case _data_type::INT64:
+            __json_append_int(m_out, sv.getInt64(f.pos));
+            break;
+        case _data_type::DOUBLE:
+            __json_append_double(m_out, sv.getDouble(f.pos));
+            break;
+        case _data_type::STRING:
+            __json_append_string(m_out, sv.getString(f.pos));
+            break;
+        case _data_type::VINT:
+            __json_append_array(m_out, sv.getInt32Vector(f.pos), __json_append_int<int32_t>);
+            break;
+        case _data_type::VINT64:
+            __json_append_array(m_out, sv.getInt64Vector(f.pos), __json_append_int<int64_t>);
+            break;
+        case _data_type::VDOUBLE:
+            __json_append_array(m_out, sv.getDoubleVector(f.pos), __json_append_double);
+            break;
+        case _data_type::VSTRING:
+            __json_append_array(m_out, sv.getStringVector(f.pos), __json_append_string);
+            break;
+        default:
+            m_out.append("null");
+        }
+    }
+
+    bool m_ndjson;
+    std::string m_namespace_labels[2];
+    std::string m_out;
+    _field_projection m_projection;
+    uint64_t m_tag;         // directory tag m_layouts were resolved against
+    std::map<_plan_key, _index_meta> m_metas;
+    std::map<_plan_key, _layout> m_layouts;
+};
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef __CAITLYN_JS_META_HPP__
+#define __CAITLYN_JS_META_HPP__
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_plan.hpp>
+
+typedef std::pair<uint32_t, uint32_t> _meta_key;
+typedef std::pair<_meta_key, uint32_t> _plan_key;
+
+/*
+ * Frozen, revision-tagged image of the loaded schema: the _index_schema the
+ * serializers reference, the latest revision of every (namespace, meta ID),
+ * every loaded revision and a decode plan per (namespace, meta ID, revision).
+ * A published image is never modified; plans are shared between images, so a
+ * new image only compiles the metas it adds.
+ */
+struct _schema_image {
+    uint64_t tag;
+    boost::shared_ptr<_index_schema> schema;
+    std::map<_meta_key, _index_meta> metas;
+    std::map<_plan_key, _index_meta> revisions;
+    std::map<_plan_key, boost::shared_ptr<const _decode_plan> > plans;
+
+    _schema_image():tag(0) {}
+
+    // keeps the highest revision of every (namespace, ID) and compiles plans it lacks
+    void add(const _index_meta& meta) {
+        _meta_key __key((uint32_t)meta.namespace_, (uint32_t)meta.id_);
+        _plan_key __plan(__key, (uint32_t)meta.revision_);
+        if(!plans.count(__plan)){
+            plans[__plan] = boost::make_shared<const _decode_plan>(meta);
+        }
+        revisions[__plan] = meta;
+        std::map<_meta_key, _index_meta>::iterator it = metas.find(__key);
+        if(it == metas.end() || it->second.revision_ <= meta.revision_){
+            metas[__key] = meta;
+        }
+    }
+    // latest revision of (namespace, ID), 0 when not loaded
+    const _index_meta* find(uint32_t ns, uint32_t id) const {
+        std::map<_meta_key, _index_meta>::const_iterator it = metas.find(_meta_key(ns, id));
+        return it == metas.end() ? 0 : &it->second;
+    }
+    // (namespace, ID) at revision, 0 when that revision is not loaded
+    const _index_meta* find(uint32_t ns, uint32_t id, uint32_t revision) const {
+        std::map<_plan_key, _index_meta>::const_iterator it = revisions.find(_plan_key(_meta_key(ns, id), revision));
+        return it == revisions.end() ? 0 : &it->second;
+    }
+};
+typedef boost::shared_ptr<const _schema_image> _schema_image_ptr;
+
+inline bool __same_meta_revision(const _index_meta& a, const _index_meta& b) {
+    return a.namespace_ == b.namespace_ && a.id_ == b.id_ && a.revision_ == b.revision_;
+}
+
+inline bool __same_meta_layout(const _index_meta& a, const _index_meta& b) {
+    if(a.fields_.size() != b.fields_.size()){
+        return false;
+    }
+    for(size_t i = 0; i < a.fields_.size(); i++){
+        if(a.fields_[i].name_ != b.fields_[i].name_ || a.fields_[i].type_ != b.fields_[i].type_){
+            return false;
+        }
+    }
+    return true;
+}
+
+// _index_schema keeps its metas in metas_, the list _get_index_schema_metas() returns
+inline void __schema_upsert_meta(_index_schema& schema, const _index_meta& meta) {
+    for(size_t i = 0; i < schema.metas_.size(); i++){
+        if(__same_meta_revision(schema.metas_[i], meta)){
+            schema.metas_[i] = meta;
+            return;
+        }
+    }
+    schema.metas_.push_back(meta);
+}
+
+/*
+ * Process wide, copy-on-write schema registry, fed by
+ * IndexSerializer.updateSchema(). Native helpers use it to resolve field
+ * names, types and decode plans of decoded StructValues without a round
+ * trip through JS.
+ * load() builds a new image next to the current one and swaps it in
+ * atomically. find() and plan() read one image() and return shared pointers
+ * that keep it alive, so results stay valid across a swap; code resolving
+ * many records holds image() and uses _schema_image::find()/plan() directly.
+ */
+class _meta_directory {
+public:
+    static _meta_directory& instance() {
+        static _meta_directory __directory;
+        return __directory;
+    }
+
+    /*
+     * Publishes the metas of schema and returns the schema serializers should
+     * reference. The first schema is taken as is; later ones are merged into
+     * the current schema like apply_delta(), so metas a delta applied survive
+     * another connection loading the original full schema, and a schema with
+     * nothing new returns the current one: every serializer of the module
+     * shares one _index_schema.
+     */
+    boost::shared_ptr<_index_schema> load(const boost::shared_ptr<_index_schema>& schema) {
+        std::vector<_index_meta> __metas = _get_index_schema_metas(*schema);
+        std::lock_guard<std::mutex> __lock(m_writer);
+        _schema_image_ptr __current = image();
+        if(__current->schema){
+            merge(*__current, __metas);
+            return image()->schema;
+        }
+        boost::shared_ptr<_schema_image> __next = boost::make_shared<_schema_image>(*__current);
+        __next->tag = __current->tag + 1;
+        __next->schema = schema;
+        for(size_t i = 0; i < __metas.size(); i++){
+            __next->add(__metas[i]);
+        }
+        publish(__next);
+        return schema;
+    }
+    /*
+     * Adds or replaces individual metas by (namespace, ID, revision) on a copy
+     * of the current schema. Other entries, older revisions of the same meta
+     * included, stay in the new image and remain decodable; only the plans of
+     * the applied metas are compiled. Metas already loaded with the same field
+     * layout are skipped. Returns the number of metas applied.
+     */
+    size_t apply_delta(const std::vector<_index_meta>& metas) {
+        std::lock_guard<std::mutex> __lock(m_writer);
+        return merge(*image(), metas);
+    }
+    _schema_image_ptr image() const {
+        return boost::atomic_load(&m_image);
+    }
+    uint64_t tag() const {
+        return image()->tag;
+    }
+    // shares ownership of the image the meta lives in
+    boost::shared_ptr<const _index_meta> find(uint32_t ns, uint32_t id) const {
+        _schema_image_ptr __image = image();
+        const _index_meta* __meta = __image->find(ns, id);
+        return __meta ? boost::shared_ptr<const _index_meta>(__image, __meta) : boost::shared_ptr<const _index_meta>();
+    }
+    boost::shared_ptr<const _index_meta> find(_sv& sv) const {
+        return find((uint32_t)sv.getNamespace(), (uint32_t)sv.getMetaID());
+    }
+    boost::shared_ptr<const _decode_plan> plan(uint32_t ns, uint32_t id, uint32_t revision) const {
+        _schema_image_ptr __image = image();
+        std::map<_plan_key, boost::shared_ptr<const _decode_plan> >::const_iterator it = __image->plans.find(_plan_key(_meta_key(ns, id), revision));
+        return it == __image->plans.end() ? boost::shared_ptr<const _decode_plan>() : it->second;
+    }
+    // plan of the latest loaded revision
+    boost::shared_ptr<const _decode_plan> plan(_sv& sv) const {
+        _schema_image_ptr __image = image();
+        const _index_meta* __meta = __image->find((uint32_t)sv.getNamespace(), (uint32_t)sv.getMetaID());
+        return __meta ? plan_of(*__image, *__meta) : boost::shared_ptr<const _decode_plan>();
+    }
+    size_t plan_count() const {
+        return image()->plans.size();
+    }
+    // position of a field in the StructValue, -1 when the meta has no such field
+    static int32_t field_pos(const _index_meta& meta, const std::string& name) {
+        for(size_t i = 0; i < meta.fields_.size(); i++){
+            if(meta.fields_[i].name_ == name){
+                return (int32_t)i;
+            }
+        }
+        return -1;
+    }
+private:
+    _meta_directory():m_image(boost::make_shared<const _schema_image>()) {}
+
+    static boost::shared_ptr<const _decode_plan> plan_of(const _schema_image& image, const _index_meta& meta) {
+        std::map<_plan_key, boost::shared_ptr<const _decode_plan> >::const_iterator it
+            = image.plans.find(_plan_key(_meta_key((uint32_t)meta.namespace_, (uint32_t)meta.id_), (uint32_t)meta.revision_));
+        return it == image.plans.end() ? boost::shared_ptr<const _decode_plan>() : it->second;
+    }
+    // callers hold m_writer, so no update is built on an image another writer replaced
+    size_t merge(const _schema_image& current, const std::vector<_index_meta>& metas) {
+        std::vector<_index_meta> __loaded;
+        if(current.schema){
+            __loaded = _get_index_schema_metas(*current.schema);
+        }
+        boost::shared_ptr<_schema_image> __next;
+        size_t __applied = 0;
+        for(size_t i = 0; i < metas.size(); i++){
+            bool __known = false;
+            for(size_t j = 0; j < __loaded.size() && !__known; j++){
+                __known = __same_meta_revision(__loaded[j], metas[i]) && __same_meta_layout(__loaded[j], metas[i]);
+            }
+            if(__known){
+                continue;
+            }
+            if(!__next){
+                __next = boost::make_shared<_schema_image>(current);
+                __next->tag = current.tag + 1;
+                __next->schema = current.schema ? boost::make_shared<_index_schema>(*current.schema) : boost::make_shared<_index_schema>();
+            }
+            __schema_upsert_meta(*__next->schema, metas[i]);
+            __next->plans.erase(_plan_key(_meta_key((uint32_t)metas[i].namespace_, (uint32_t)metas[i].id_), (uint32_t)metas[i].revision_));
+            __next->add(metas[i]);
+            __applied++;
+        }
+        if(__next){
+            publish(__next);
+        }
+        return __applied;
+    }
+    void publish(const _schema_image_ptr& next) {
+        boost::atomic_store(&m_image, next);
+    }
+
+    _schema_image_ptr m_image;
+    std::mutex m_writer;    // serializes load() and apply_delta()
+};
+
+// StructValue.toObject(): fields by name through the compiled plan, null when the meta is unknown
+inline emscripten::val _sv_to_object(_sv& sv) {
+    boost::shared_ptr<const _decode_plan> __plan = _meta_directory::instance().plan(sv);
+    return __plan ? __plan->to_js(sv) : emscripten::val::null();
+}
+
+// ATFetchSVRes.objects(): toObject() of every record, the plan is looked up once per meta
+inline emscripten::val _get_sv_res_objects(_at_fetch_sv_res& res) {
+    std::vector<_sv_ptr> __rows = _get_sv_res(res);
+    emscripten::val __ret = emscripten::val::array();
+    boost::shared_ptr<const _decode_plan> __plan;
+    for(size_t i = 0; i < __rows.size(); i++){
+        _sv& __sv = *__rows[i];
+        if(!__plan || __plan->id() != (uint32_t)__sv.getMetaID() || __plan->ns() != (uint32_t)__sv.getNamespace()){
+            __plan = _meta_directory::instance().plan(__sv);
+        }
+        __ret.set(i, __plan ? __plan->to_js(__sv) : emscripten::val::null());
+    }
+    return __ret;
+}
+
+/*
+ * Field projection resolved per meta. Positions are computed once for every
+ * (namespace, ID, revision) and reused, so extraction loops only touch the
+ * requested fields. An empty projection keeps every field.
+ */
+class _field_projection {
+public:
+    _field_projection() {}
+    explicit _field_projection(const std::vector<std::string>& names):m_names(names) {}
+
+    bool empty() const {
+        return m_names.empty();
+    }
+    const std::vector<std::string>& names() const {
+        return m_names;
+    }
+    // positions of the projected fields in meta order
+    const std::vector<int32_t>& positions(const _index_meta& meta) {
+        _projection_key __key(_meta_key((uint32_t)meta.namespace_, (uint32_t)meta.id_), (uint32_t)meta.revision_);
+        std::map<_projection_key, std::vector<int32_t> >::iterator it = m_positions.find(__key);
+        if(it != m_positions.end()){
+            return it->second;
+        }
+        std::vector<int32_t>& __positions = m_positions[__key];
+        for(size_t i = 0; i < meta.fields_.size(); i++){
+            if(empty() || std::find(m_names.begin(), m_names.end(), meta.fields_[i].name_) != m_names.end()){
+                __positions.push_back((int32_t)i);
+            }
+        }
+        return __positions;
+    }
+    // 1 for every kept field of the meta, null when the meta is not loaded
+    emscripten::val mask(uint32_t ns, uint32_t id) {
+        boost::shared_ptr<const _index_meta> __meta = _meta_directory::instance().find(ns, id);
+        if(!__meta){
+            return emscripten::val::null();
+        }
+        std::vector<uint8_t> __mask(__meta->fields_.size(), 0);
+        const std::vector<int32_t>& __positions = positions(*__meta);
+        for(size_t i = 0; i < __positions.size(); i++){
+            __mask[__positions[i]] = 1;
+        }
+        emscripten::val __ret = emscripten::val::global("Uint8Array").new_(__mask.size());
+        if(!__mask.empty()){
+            __ret.call<void>("set", emscripten::val(emscripten::typed_memory_view(__mask.size(), &__mask[0])));
+        }
+        return __ret;
+    }
+    emscripten::val positions_of(uint32_t ns, uint32_t id) {
+        boost::shared_ptr<const _index_meta> __meta = _meta_directory::instance().find(ns, id);
+        if(!__meta){
+            return emscripten::val::null();
+        }
+        const std::vector<int32_t>& __positions = positions(*__meta);
+        emscripten::val __ret = emscripten::val::global("Int32Array").new_(__positions.size());
+        if(!__positions.empty()){
+            __ret.call<void>("set", emscripten::val(emscripten::typed_memory_view(__positions.size(), &__positions[0])));
+        }
+        return __ret;
+    }
+private:
+    typedef std::pair<_meta_key, uint32_t> _projection_key;
+
+    std::vector<std::string> m_names;
+    std::map<_projection_key, std::vector<int32_t> > m_positions;
+};
+
+// FieldProjection(fieldNames)
+inline _field_projection _make_field_projection(emscripten::val field_names) {
+    return _field_projection(emscripten::vecFromJSArray<std::string>(field_names));
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef __CAITLYN_JS_PLAN_HPP__
+#define __CAITLYN_JS_PLAN_HPP__
+
+#include <string>
+#include <vector>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+
+enum _plan_op_code {
+    PLAN_INT = 0,
+    PLAN_INT64,
+    PLAN_DOUBLE,
+    PLAN_STRING,
+    PLAN_VINT,
+    PLAN_VINT64,
+    PLAN_VDOUBLE,
+    PLAN_VSTRING,
+    PLAN_SKIP
+};
+
+// one field of a meta: what to read, from where, and the key to export it under
+struct _plan_op {
+    uint8_t code;
+    int32_t pos;
+    std::string name;
+};
+
+inline uint8_t __plan_op_code(_data_type t) {
+    switch(t){
+    case _data_type::INT: return PLAN_INT;
+    case _data_type::INT64: return PLAN_INT64;
+    case _data_type::DOUBLE: return PLAN_DOUBLE;
+    case _data_type::STRING: return PLAN_STRING;
+    case _data_type::VINT: return PLAN_VINT;
+    case _data_type::VINT64: return PLAN_VINT64;
+    case _data_type::VDOUBLE: return PLAN_VDOUBLE;
+    case _data_type::VSTRING: return PLAN_VSTRING;
+    default: return PLAN_SKIP;
+    }
+}
+
+template<typename T>
+emscripten::val __plan_array(const std::vector<T>& v) {
+    emscripten::val __arr = emscripten::val::array();
+    for(size_t i = 0; i < v.size(); i++){
+        __arr.set(i, v[i]);
+    }
+    return __arr;
+}
+
+/*
+ * Flat extraction plan of one (namespace, ID, revision), compiled once when
+ * the schema is loaded. Running it is a single pass over a contiguous op
+ * array, with no meta lookup or type dispatch on _index_field per value.
+ * Precision and multiple are applied by the serializer while decoding the
+ * wire format, so decoded values need no scaling here.
+ */
+class _decode_plan {
+public:
+    _decode_plan():m_namespace(0), m_id(0), m_revision(0) {}
+    explicit _decode_plan(const _index_meta& meta)
+        :m_namespace((uint32_t)meta.namespace_), m_id((uint32_t)meta.id_), m_revision((uint32_t)meta.revision_)
+    {
+        m_ops.reserve(meta.fields_.size());
+        for(size_t i = 0; i < meta.fields_.size(); i++){
+            _plan_op __op;
+            __op.code = __plan_op_code(meta.fields_[i].type_);
+            __op.pos = (int32_t)i;
+            __op.name = meta.fields_[i].name_;
+            m_ops.push_back(__op);
+        }
+    }
+
+    uint32_t ns() const { return m_namespace; }
+    uint32_t id() const { return m_id; }
+    uint32_t revision() const { return m_revision; }
+    const std::vector<_plan_op>& ops() const { return m_ops; }
+
+    // {field: value}, empty fields are null and INT64 values strings like StructValue.getInt64()
+    emscripten::val to_js(_sv& sv) const {
+        emscripten::val __obj = emscripten::val::object();
+        int32_t __size = (int32_t)sv.size();
+        const _plan_op* __op = m_ops.empty() ? 0 : &m_ops[0];
+        const _plan_op* __end = __op + m_ops.size();
+        for(; __op != __end; ++__op){
+            if(__op->pos >= __size || sv.isEmpty(__op->pos)){
+                __obj.set(__op->name, emscripten::val::null());
+                continue;
+            }
+            switch(__op->code){
+            case PLAN_INT: __obj.set(__op->name, sv.getInt(__op->pos)); break;
+            case PLAN_INT64: __obj.set(__op->name, std::to_string(sv.getInt64(__op->pos))); break;
+            case PLAN_DOUBLE: __obj.set(__op->name, sv.getDouble(__op->pos)); break;
+            case PLAN_STRING: __obj.set(__op->name, sv.getString(__op->pos)); break;
+            case PLAN_VINT: __obj.set(__op->name, __plan_array(sv.getInt32Vector(__op->pos))); break;
+            case PLAN_VINT64: __obj.set(__op->name, __plan_array(sv.getInt64VectorS(__op->pos))); break;
+            case PLAN_VDOUBLE: __obj.set(__op->name, __plan_array(sv.getDoubleVector(__op->pos))); break;
+            case PLAN_VSTRING: __obj.set(__op->name, __plan_array(sv.getStringVector(__op->pos))); break;
+            default: __obj.set(__op->name, emscripten::val::null());
+            }
+        }
+        return __obj;
+    }
+private:
+    uint32_t m_namespace;
+    uint32_t m_id;
+    uint32_t m_revision;
+    std::vector<_plan_op> m_ops;
+};
+
+#endif
@@ -0,0 +1,246 @@
+#ifndef __CAITLYN_JS_POOL_HPP__
+#define __CAITLYN_JS_POOL_HPP__
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <emscripten/threading.h>
+#endif
+
+enum _decode_kind {
+    DECODE_FETCH = 1,
+    DECODE_SEEDS = 2
+};
+
+struct _decode_task {
+    uint32_t ticket;
+    int32_t kind;
+    std::string data;
+    boost::shared_ptr<_at_fetch_sv_res> fetch;
+    boost::shared_ptr<_at_universe_seeds_res> seeds;
+    bool done;
+};
+
+// JS callback of a pool, only touched on the main runtime thread
+struct _decode_listener {
+    emscripten::val callback;
+};
+
+/*
+ * Decodes ATFetchSVRes / ATUniverseSeedsRes payloads off the main thread.
+ * submit() queues a payload and returns a ticket; worker threads decode it
+ * with their own IndexSerializer built from the pool schema, since a
+ * serializer is not safe to share between threads. completed() hands back
+ * finished tickets in submit order, so responses are merged in the order they
+ * arrived however the workers finish; takeFetch()/takeSeeds() then return the
+ * decoded response. A worker that finishes a task proxies a call of the
+ * listener to the main runtime thread, which then reads completed(). Without
+ * -pthread (and in the native addon) the payload is decoded inside submit(),
+ * completed() has it right away and the listener is neither kept nor called.
+ */
+class _decode_pool {
+public:
+    _decode_pool(size_t threads):m_next_ticket(1), m_next_release(1), m_generation(0), m_stop(false) {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        m_listener = boost::make_shared<_decode_listener>();
+        for(size_t i = 0; i < (threads ? threads : 1); i++){
+            m_workers.push_back(std::thread(&_decode_pool::work, this));
+        }
+#endif
+    }
+    ~_decode_pool() {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        // notifications still queued for the main thread find no callback
+        m_listener->callback = emscripten::val::undefined();
+        {
+            std::lock_guard<std::mutex> __lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for(size_t i = 0; i < m_workers.size(); i++){
+            m_workers[i].join();
+        }
+#endif
+    }
+
+    // workers rebuild their serializer before the next task
+    void set_schema(boost::shared_ptr<_index_schema> schema) {
+        lock_type __lock(m_mutex);
+        m_schema = schema;
+        m_generation++;
+    }
+    // listener() runs on the main runtime thread whenever a worker finished a task
+    void set_listener(emscripten::val listener) {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        m_listener->callback = listener;
+#endif
+    }
+    uint32_t submit(int32_t kind, const std::string& data) {
+        boost::shared_ptr<_decode_task> __task = boost::make_shared<_decode_task>();
+        __task->kind = kind;
+        __task->data = data;
+        __task->done = false;
+        {
+            lock_type __lock(m_mutex);
+            __task->ticket = m_next_ticket++;
+            m_tasks[__task->ticket] = __task;
+#ifdef __EMSCRIPTEN_PTHREADS__
+            m_queue.push_back(__task);
+#endif
+        }
+#ifdef __EMSCRIPTEN_PTHREADS__
+        m_wake.notify_one();
+#else
+        boost::shared_ptr<_index_serializer> __serializer = boost::make_shared<_index_serializer>();
+        if(m_schema){
+            __serializer->update_schema(m_schema);
+        }
+        decode(*__task, __serializer);
+        __task->done = true;
+#endif
+        return __task->ticket;
+    }
+    // tickets finished since the last call, in submit order
+    emscripten::val completed() {
+        std::vector<uint32_t> __tickets;
+        {
+            lock_type __lock(m_mutex);
+            while(m_next_release < m_next_ticket){
+                std::map<uint32_t, boost::shared_ptr<_decode_task> >::iterator it = m_tasks.find(m_next_release);
+                if(it != m_tasks.end() && !it->second->done){
+                    break;
+                }
+                __tickets.push_back(m_next_release++);
+            }
+        }
+        emscripten::val __ret = emscripten::val::global("Uint32Array").new_(__tickets.size());
+        if(!__tickets.empty()){
+            __ret.call<void>("set", emscripten::val(emscripten::typed_memory_view(__tickets.size(), __tickets.data())));
+        }
+        return __ret;
+    }
+    // decoded response of a completed ticket, once; null for other tickets
+    boost::shared_ptr<_at_fetch_sv_res> take_fetch(uint32_t ticket) {
+        boost::shared_ptr<_decode_task> __task = take(ticket, DECODE_FETCH);
+        return __task ? __task->fetch : boost::shared_ptr<_at_fetch_sv_res>();
+    }
+    boost::shared_ptr<_at_universe_seeds_res> take_seeds(uint32_t ticket) {
+        boost::shared_ptr<_decode_task> __task = take(ticket, DECODE_SEEDS);
+        return __task ? __task->seeds : boost::shared_ptr<_at_universe_seeds_res>();
+    }
+    size_t threads() const {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        return m_workers.size();
+#else
+        return 0;
+#endif
+    }
+    // submitted tickets not taken yet
+    size_t pending() {
+        lock_type __lock(m_mutex);
+        return m_tasks.size();
+    }
+private:
+#ifdef __EMSCRIPTEN_PTHREADS__
+    typedef std::lock_guard<std::mutex> lock_type;
+#else
+    struct lock_type {
+        lock_type(int) {}
+    };
+#endif
+
+    boost::shared_ptr<_decode_task> take(uint32_t ticket, int32_t kind) {
+        lock_type __lock(m_mutex);
+        std::map<uint32_t, boost::shared_ptr<_decode_task> >::iterator it = m_tasks.find(ticket);
+        if(it == m_tasks.end() || !it->second->done || ticket >= m_next_release || it->second->kind != kind){
+            return boost::shared_ptr<_decode_task>();
+        }
+        boost::shared_ptr<_decode_task> __task = it->second;
+        m_tasks.erase(it);
+        return __task;
+    }
+
+    // same entity calls as __decode_ws_binary_as_str, on the worker's serializer
+    static void decode(_decode_task& task, boost::shared_ptr<_index_serializer>& serializer) {
+        const uint8_t* __data = (const uint8_t*)task.data.data();
+        if(task.kind == DECODE_FETCH){
+            task.fetch = boost::make_shared<_at_fetch_sv_res>();
+            _set_compressor<_at_fetch_sv_res>(*task.fetch, serializer);
+            task.fetch->decode_binary(__data, task.data.size());
+        }else if(task.kind == DECODE_SEEDS){
+            task.seeds = boost::make_shared<_at_universe_seeds_res>();
+            _set_compressor<_at_universe_seeds_res>(*task.seeds, serializer);
+            task.seeds->decode_binary(__data, task.data.size());
+        }
+        std::string().swap(task.data);
+    }
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+    void work() {
+        boost::shared_ptr<_index_serializer> __serializer;
+        uint32_t __generation = 0;
+        for(;;){
+            boost::shared_ptr<_decode_task> __task;
+            boost::shared_ptr<_index_schema> __schema;
+            {
+                std::unique_lock<std::mutex> __lock(m_mutex);
+                m_wake.wait(__lock, [this]{ return m_stop || !m_queue.empty(); });
+                if(m_stop){
+                    return;
+                }
+                __task = m_queue.front();
+                m_queue.pop_front();
+                if(!__serializer || __generation != m_generation){
+                    __schema = m_schema;
+                    __generation = m_generation;
+                }
+            }
+            if(__schema || !__serializer){
+                __serializer = boost::make_shared<_index_serializer>();
+                if(__schema){
+                    __serializer->update_schema(__schema);
+                }
+            }
+            decode(*__task, __serializer);
+            {
+                std::lock_guard<std::mutex> __lock(m_mutex);
+                __task->done = true;
+            }
+            // the copy keeps the listener alive until the main thread ran it
+            emscripten_async_run_in_main_runtime_thread(EM_FUNC_SIG_VI, &_decode_pool::notify,
+                (int)(intptr_t)new boost::shared_ptr<_decode_listener>(m_listener));
+        }
+    }
+    static void notify(int arg) {
+        boost::shared_ptr<_decode_listener>* __listener = (boost::shared_ptr<_decode_listener>*)(intptr_t)arg;
+        if(!(*__listener)->callback.isUndefined()){
+            (*__listener)->callback();
+        }
+        delete __listener;
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::thread> m_workers;
+    std::deque<boost::shared_ptr<_decode_task> > m_queue;
+    boost::shared_ptr<_decode_listener> m_listener;
+#else
+    int m_mutex;
+#endif
+    uint32_t m_next_ticket;
+    uint32_t m_next_release;
+    uint32_t m_generation;
+    bool m_stop;
+    boost::shared_ptr<_index_schema> m_schema;
+    std::map<uint32_t, boost::shared_ptr<_decode_task> > m_tasks;
+};
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef __CAITLYN_JS_RESAMPLE_HPP__
+#define __CAITLYN_JS_RESAMPLE_HPP__
+
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_meta.hpp>
+#include <caitlyn_js_columns.hpp>
+
+inline int64_t __floor_div(int64_t a, int64_t b) {
+    int64_t __q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? __q - 1 : __q;
+}
+
+// trading periods are HHMMSS local times
+inline int32_t __period_seconds(int32_t hhmmss) {
+    return (hhmmss / 10000) * 3600 + (hhmmss / 100 % 100) * 60 + hhmmss % 100;
+}
+
+/*
+ * Maps a bar time tag (ms) to the start of its target bar. Time tags are bar
+ * starts on both sides: a source bar stamped t covers [t, t + its granularity)
+ * and lands in the target bar whose start is returned. Without sessions bars
+ * are cut on the clock, shifted by the UTC offset. With the trading periods of
+ * a SamplerConfiguration they are cut from the start of each session, and the
+ * last bar of a session ends with it, so a bar never spans a break; a source
+ * bar belongs to the session [begin, end) holding its start. Sessions ending
+ * before they begin run past midnight. Time tags outside every session, and
+ * targets of a day or more, fall back to the clock.
+ */
+class _resample_clock {
+public:
+    _resample_clock(int32_t granularity, int32_t utc_offset)
+        :m_granularity(granularity), m_offset(utc_offset) {}
+
+    // periods of the code, its product (leading letters), then "*"
+    void set_sessions(const _uout_sampler_configuration& config, const std::string& code) {
+        m_sessions.clear();
+        if(m_granularity >= 86400){
+            return;
+        }
+        std::string __product;
+        for(size_t i = 0; i < code.size() && std::isalpha((unsigned char)code[i]); i++){
+            __product.push_back(code[i]);
+        }
+        const char* __keys[] = {code.c_str(), __product.c_str(), "*"};
+        for(size_t k = 0; k < 3 && m_sessions.empty(); k++){
+            std::map<std::string, std::vector<std::pair<int32_t, int32_t> > >::const_iterator it = config.trading_period.find(__keys[k]);
+            if(it == config.trading_period.end()){
+                continue;
+            }
+            for(size_t i = 0; i < it->second.size(); i++){
+                int32_t __begin = __period_seconds(it->second[i].first);
+                int32_t __end = __period_seconds(it->second[i].second);
+                if(__end <= __begin){
+                    __end += 86400;
+                }
+                m_sessions.push_back(std::make_pair(__begin, __end));
+            }
+        }
+    }
+    int64_t bucket(int64_t time_tag) const {
+        int64_t __sec = __floor_div(time_tag, 1000) + m_offset;
+        int64_t __day = __floor_div(__sec, 86400) * 86400;
+        int32_t __tod = (int32_t)(__sec - __day);
+        for(size_t i = 0; i < m_sessions.size(); i++){
+            int32_t __begin = m_sessions[i].first;
+            int32_t __end = m_sessions[i].second;
+            int64_t __anchor = __day;
+            int32_t __t = __tod;
+            if(__end > 86400 && __tod < __end - 86400){
+                // after midnight part of a night session
+                __t += 86400;
+                __anchor -= 86400;
+            }
+            if(__t >= __begin && __t < __end){
+                int32_t __offset = (__t - __begin) / m_granularity * m_granularity;
+                return (__anchor + __begin + __offset - m_offset) * 1000;
+            }
+        }
+        return (__floor_div(__sec, m_granularity) * m_granularity - m_offset) * 1000;
+    }
+private:
+    int32_t m_granularity;
+    int32_t m_offset;
+    std::vector<std::pair<int32_t, int32_t> > m_sessions;
+};
+
+/*
+ * OHLCV roll-up of decoded bars into bars of a coarser granularity in one pass
+ * over the records: open of the first, high/low over all, close of the last,
+ * volume and turnover summed. Fields the meta lacks are left out; empty values
+ * are skipped. A new bar starts whenever the bucket, market or code changes.
+ * With a SamplerConfiguration every code is cut by its own trading sessions.
+ */
+class _ohlcv_resampler {
+public:
+    enum { OPEN = 0, HIGH, LOW, CLOSE, VOLUME, TURNOVER, FIELDS };
+
+    _ohlcv_resampler(int32_t granularity, int32_t utc_offset, const _uout_sampler_configuration* config)
+        :m_clock(granularity, utc_offset), m_config(config), m_granularity(granularity), m_meta(0), m_open(false) {}
+
+    // false if the meta of the records is not in the loaded schema
+    bool bind(_sv& first) {
+        static const char* __names[FIELDS] = {"open", "high", "low", "close", "volume", "turnover"};
+        m_image = _meta_directory::instance().image();
+        std::map<_meta_key, _index_meta>::const_iterator it = m_image->metas.find(_meta_key((uint32_t)first.getNamespace(), (uint32_t)first.getMetaID()));
+        m_meta = it == m_image->metas.end() ? 0 : &it->second;
+        if(!m_meta){
+            return false;
+        }
+        for(int f = 0; f < FIELDS; f++){
+            int32_t __pos = _meta_directory::field_pos(*m_meta, __names[f]);
+            m_pos[f] = __pos >= 0 && _sv_column::is_numeric(m_meta->fields_[__pos].type_) ? __pos : -1;
+            m_type[f] = __pos >= 0 ? m_meta->fields_[__pos].type_ : _data_type::DOUBLE;
+        }
+        return true;
+    }
+    void append(_sv& sv) {
+        int32_t __market = m_market_dict.intern(sv.getMarket());
+        int32_t __code = m_code_dict.intern(sv.getStockCode());
+        int64_t __bucket = clock_of(__code).bucket((int64_t)sv.getTimeTag());
+        if(!m_open || __bucket != m_time_tags.back() || __market != m_markets.back() || __code != m_codes.back()){
+            m_time_tags.push_back(__bucket);
+            m_markets.push_back(__market);
+            m_codes.push_back(__code);
+            m_rows.push_back(0);
+            for(int f = 0; f < FIELDS; f++){
+                m_values[f].push_back(std::numeric_limits<double>::quiet_NaN());
+            }
+            m_open = true;
+        }
+        m_rows.back()++;
+        for(int f = 0; f < FIELDS; f++){
+            if(m_pos[f] < 0){
+                continue;
+            }
+            double __v = value(sv, f);
+            if(std::isnan(__v)){
+                continue;
+            }
+            double& __bar = m_values[f].back();
+            if(f == OPEN){
+                if(std::isnan(__bar)) __bar = __v;
+            }else if(f == HIGH){
+                if(std::isnan(__bar) || __v > __bar) __bar = __v;
+            }else if(f == LOW){
+                if(std::isnan(__bar) || __v < __bar) __bar = __v;
+            }else if(f == CLOSE){
+                __bar = __v;
+            }else{
+                __bar = std::isnan(__bar) ? __v : __bar + __v;
+            }
+        }
+    }
+    /*
+     * {count, granularity, namespace, metaID, timeTags: BigInt64Array (bar
+     *  start), rows: Int32Array (source bars), markets, codes, marketDict,
+     *  codeDict, fields: {open, high, low, close, volume, turnover: Float64Array}}
+     */
+    emscripten::val to_js() const {
+        static const char* __names[FIELDS] = {"open", "high", "low", "close", "volume", "turnover"};
+        emscripten::val __ret = emscripten::val::object();
+        emscripten::val __fields = emscripten::val::object();
+        __ret.set("count", m_time_tags.size());
+        __ret.set("granularity", m_granularity);
+        if(m_meta){
+            __ret.set("namespace", (uint32_t)m_meta->namespace_);
+            __ret.set("metaID", (uint32_t)m_meta->id_);
+        }
+        __ret.set("timeTags", __to_typed_array(m_time_tags, "BigInt64Array"));
+        __ret.set("rows", __to_typed_array(m_rows, "Int32Array"));
+        __ret.set("markets", __to_typed_array(m_markets, "Int32Array"));
+        __ret.set("codes", __to_typed_array(m_codes, "Int32Array"));
+        __ret.set("marketDict", __to_string_array(m_market_dict.values()));
+        __ret.set("codeDict", __to_string_array(m_code_dict.values()));
+        for(int f = 0; f < FIELDS; f++){
+            if(m_meta && m_pos[f] >= 0){
+                __fields.set(__names[f], __to_typed_array(m_values[f], "Float64Array"));
+            }
+        }
+        __ret.set("fields", __fields);
+        return __ret;
+    }
+private:
+    // sessions are looked up once per interned code
+    const _resample_clock& clock_of(int32_t code) {
+        if(!m_config){
+            return m_clock;
+        }
+        while((int32_t)m_clocks.size() <= code){
+            m_clocks.push_back(m_clock);
+            m_clocks.back().set_sessions(*m_config, m_code_dict.values()[m_clocks.size() - 1]);
+        }
+        return m_clocks[code];
+    }
+    double value(_sv& sv, int f) const {
+        int32_t __pos = m_pos[f];
+        if(__pos >= (int32_t)sv.size() || sv.isEmpty(__pos)){
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if(m_type[f] == _data_type::INT) return (double)sv.getInt(__pos);
+        if(m_type[f] == _data_type::INT64) return (double)sv.getInt64(__pos);
+        return sv.getDouble(__pos);
+    }
+
+    _resample_clock m_clock;
+    std::vector<_resample_clock> m_clocks;      // per code id, with a config only
+    const _uout_sampler_configuration* m_config;
+    int32_t m_granularity;
+    _schema_image_ptr m_image;
+    const _index_meta* m_meta;
+    int32_t m_pos[FIELDS];
+    _data_type m_type[FIELDS];
+    bool m_open;
+    std::vector<int64_t> m_time_tags;
+    std::vector<int32_t> m_rows;
+    std::vector<int32_t> m_markets;
+    std::vector<int32_t> m_codes;
+    std::vector<double> m_values[FIELDS];
+    _string_dict m_market_dict;
+    _string_dict m_code_dict;
+};
+
+inline emscripten::val __resample_rows(_at_fetch_sv_res& res, int32_t granularity, int32_t utc_offset, const _uout_sampler_configuration* config) {
+    if(granularity <= 0){
+        return emscripten::val::null();
+    }
+    std::vector<_sv_ptr> __rows = _get_sv_res(res);
+    _ohlcv_resampler __resampler(granularity, utc_offset, config);
+    if(!__rows.empty()){
+        if(!__resampler.bind(*__rows[0])){
+            return emscripten::val::null();
+        }
+        for(size_t i = 0; i < __rows.size(); i++){
+            __resampler.append(*__rows[i]);
+        }
+    }
+    return __resampler.to_js();
+}
+
+// resample(res, targetGranularity): clock aligned bars in UTC; null for an unknown meta
+inline emscripten::val _resample(_at_fetch_sv_res& res, int32_t granularity) {
+    return __resample_rows(res, granularity, 0, 0);
+}
+
+// resample(res, targetGranularity, utcOffsetSeconds): clock aligned bars in local time
+inline emscripten::val _resample_local(_at_fetch_sv_res& res, int32_t granularity, int32_t utc_offset) {
+    return __resample_rows(res, granularity, utc_offset, 0);
+}
+
+// resample(res, targetGranularity, samplerConfiguration, utcOffsetSeconds): bars cut by trading session
+inline emscripten::val _resample_sessions(_at_fetch_sv_res& res, int32_t granularity, const _uout_sampler_configuration& config, int32_t utc_offset) {
+    return __resample_rows(res, granularity, utc_offset, &config);
+}
+
+// ResampleClock.setSessions(samplerConfiguration, code)
+inline void _resample_clock_set_sessions(_resample_clock& clock, const _uout_sampler_configuration& config, const std::string& code) {
+    clock.set_sessions(config, code);
+}
+
+// ResampleClock.bucket(timeTag): start of the target bar (ms) of a bar starting at timeTag (ms)
+inline double _resample_clock_bucket(_resample_clock& clock, double time_tag) {
+    return (double)clock.bucket((int64_t)time_tag);
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __CAITLYN_JS_SCHEMA_HPP__
+#define __CAITLYN_JS_SCHEMA_HPP__
+
+#include <cstring>
+#include <string>
+#include <caitlyn_js_types.hpp>
+
+/*
+ * Binary IndexSchema snapshot, shared by the WASM and native builds:
+ *
+ *   'C' 'S' 'N' 'P'  u16 version  u16 reserved  u32 length  u32 fnv1a(payload)  payload
+ *
+ * little endian; payload is the schema's own binary encoding, so loading a
+ * snapshot skips the decompress and parse of IndexSchema.load(). The checksum guards
+ * against stale or truncated cache files, a failed check leaves the schema
+ * untouched and the caller falls back to load().
+ */
+const uint8_t __SCHEMA_SNAPSHOT_MAGIC[4] = {'C', 'S', 'N', 'P'};
+const uint16_t __SCHEMA_SNAPSHOT_VERSION = 1;
+const size_t __SCHEMA_SNAPSHOT_HEADER = 16;
+
+inline uint32_t __fnv1a(const uint8_t* data, size_t size) {
+    uint32_t __hash = 2166136261u;
+    for(size_t i = 0; i < size; i++){
+        __hash = (__hash ^ data[i]) * 16777619u;
+    }
+    return __hash;
+}
+
+inline void __snapshot_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+inline uint32_t __snapshot_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void _save_schema_snapshot(_index_schema& schema, ByteArray& out) {
+    ByteArray __payload;
+    schema.encode_binary(__payload);
+    out.resize(__SCHEMA_SNAPSHOT_HEADER + __payload.size());
+    uint8_t* __p = &out[0];
+    std::memcpy(__p, __SCHEMA_SNAPSHOT_MAGIC, 4);
+    __p[4] = (uint8_t)__SCHEMA_SNAPSHOT_VERSION;
+    __p[5] = (uint8_t)(__SCHEMA_SNAPSHOT_VERSION >> 8);
+    __p[6] = 0;
+    __p[7] = 0;
+    __snapshot_put_u32(__p + 8, (uint32_t)__payload.size());
+    __snapshot_put_u32(__p + 12, __payload.empty() ? __fnv1a(0, 0) : __fnv1a(&__payload[0], __payload.size()));
+    if(!__payload.empty()){
+        std::memcpy(__p + __SCHEMA_SNAPSHOT_HEADER, &__payload[0], __payload.size());
+    }
+}
+
+// true when data is a valid snapshot and was decoded into schema
+inline bool _load_schema_snapshot(_index_schema& schema, const uint8_t* data, size_t size) {
+    if(size < __SCHEMA_SNAPSHOT_HEADER || std::memcmp(data, __SCHEMA_SNAPSHOT_MAGIC, 4) != 0){
+        return false;
+    }
+    uint16_t __version = (uint16_t)(data[4] | (data[5] << 8));
+    uint32_t __length = __snapshot_get_u32(data + 8);
+    if(__version != __SCHEMA_SNAPSHOT_VERSION || __length != size - __SCHEMA_SNAPSHOT_HEADER){
+        return false;
+    }
+    const uint8_t* __payload = data + __SCHEMA_SNAPSHOT_HEADER;
+    if(__fnv1a(__payload, __length) != __snapshot_get_u32(data + 12)){
+        return false;
+    }
+    schema.decode_binary(__payload, __length);
+    return true;
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef __CAITLYN_JS_SECURITY_HPP__
+#define __CAITLYN_JS_SECURITY_HPP__
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_meta.hpp>
+#include <caitlyn_js_columns.hpp>
+
+struct _security_entry {
+    int32_t market;
+    int32_t code;
+    int32_t name;
+    int32_t type;       // meta name after "::", e.g. "Security"
+    uint32_t ns;
+    uint32_t meta_id;
+};
+
+/*
+ * Securities listed by universe seeds, indexed natively. add() walks the
+ * seeds of an ATUniverseSeedsRes once: every record carrying a "code" or
+ * "codes" string vector adds one entry per element, named by the matching
+ * element of "name"/"names", under the market in the record's stock code.
+ * Strings are interned, (market, code) is hashed for lookup() and codes are
+ * kept sorted case-insensitively for prefixSearch(). Re-adding a (market,
+ * code) pair, e.g. after a reconnect, updates its entry in place.
+ */
+class _security_master {
+public:
+    _security_master():m_sorted_valid(true) {}
+
+    // entries added or updated from the response
+    size_t add(_at_universe_seeds_res& res) {
+        std::vector<_sv_ptr> __rows = _get_seed_data(res);
+        _schema_image_ptr __image = _meta_directory::instance().image();
+        std::map<_meta_key, _layout> __layouts;
+        size_t __added = 0;
+        for(size_t i = 0; i < __rows.size(); i++){
+            _sv& __sv = *__rows[i];
+            _meta_key __key((uint32_t)__sv.getNamespace(), (uint32_t)__sv.getMetaID());
+            std::map<_meta_key, _layout>::iterator it = __layouts.find(__key);
+            if(it == __layouts.end()){
+                it = __layouts.insert(std::make_pair(__key, layout(*__image, __key))).first;
+            }
+            const _layout& __layout = it->second;
+            if(__layout.code < 0 || __layout.code >= (int32_t)__sv.size() || __sv.isEmpty(__layout.code)){
+                continue;
+            }
+            const auto& __codes = __sv.getStringVector(__layout.code);
+            std::vector<std::string> __names;
+            if(__layout.name >= 0 && __layout.name < (int32_t)__sv.size() && !__sv.isEmpty(__layout.name)){
+                __names = __sv.getStringVector(__layout.name);
+            }
+            int32_t __market = m_strings.intern(__sv.getStockCode());
+            for(size_t j = 0; j < __codes.size(); j++){
+                _security_entry __entry;
+                __entry.market = __market;
+                __entry.code = m_strings.intern(__codes[j]);
+                __entry.name = m_strings.intern(j < __names.size() ? __names[j] : std::string());
+                __entry.type = __layout.type;
+                __entry.ns = __key.first;
+                __entry.meta_id = __key.second;
+                put(__entry);
+                __added++;
+            }
+        }
+        return __added;
+    }
+    size_t size() const {
+        return m_entries.size();
+    }
+    void clear() {
+        m_entries.clear();
+        m_lower.clear();
+        m_index.clear();
+        m_sorted.clear();
+        m_strings.clear();
+        m_sorted_valid = true;
+    }
+    // {market, code, name, type, namespace, metaID}, null when unknown
+    emscripten::val lookup(const std::string& market, const std::string& code) const {
+        int32_t __market = m_strings.find(market);
+        int32_t __code = m_strings.find(code);
+        if(__market < 0 || __code < 0){
+            return emscripten::val::null();
+        }
+        boost::unordered_map<uint64_t, uint32_t>::const_iterator it = m_index.find(key(__market, __code));
+        return it == m_index.end() ? emscripten::val::null() : to_js(m_entries[it->second]);
+    }
+    // entries whose code starts with prefix, case-insensitive, in code order; "" market searches all, limit 0 returns all
+    emscripten::val prefix_search(const std::string& prefix, const std::string& market, size_t limit) {
+        emscripten::val __ret = emscripten::val::array();
+        int32_t __market = market.empty() ? -1 : m_strings.find(market);
+        if(!market.empty() && __market < 0){
+            return __ret;
+        }
+        sort();
+        std::string __prefix = lower(prefix);
+        std::vector<uint32_t>::const_iterator it = std::lower_bound(m_sorted.begin(), m_sorted.end(), __prefix,
+            [this](uint32_t id, const std::string& p){ return m_lower[id] < p; });
+        size_t __found = 0;
+        for(; it != m_sorted.end() && (!limit || __found < limit); ++it){
+            const std::string& __code = m_lower[*it];
+            if(__code.compare(0, __prefix.size(), __prefix) != 0){
+                break;
+            }
+            if(__market >= 0 && m_entries[*it].market != __market){
+                continue;
+            }
+            __ret.call<void>("push", to_js(m_entries[*it]));
+            __found++;
+        }
+        return __ret;
+    }
+    // markets with at least one entry
+    emscripten::val markets() const {
+        std::vector<int32_t> __ids;
+        for(size_t i = 0; i < m_entries.size(); i++){
+            __ids.push_back(m_entries[i].market);
+        }
+        std::sort(__ids.begin(), __ids.end());
+        __ids.erase(std::unique(__ids.begin(), __ids.end()), __ids.end());
+        emscripten::val __ret = emscripten::val::array();
+        for(size_t i = 0; i < __ids.size(); i++){
+            __ret.call<void>("push", m_strings.values()[__ids[i]]);
+        }
+        return __ret;
+    }
+private:
+    struct _layout {
+        int32_t code;
+        int32_t name;
+        int32_t type;
+    };
+
+    static uint64_t key(int32_t market, int32_t code) {
+        return ((uint64_t)(uint32_t)market << 32) | (uint32_t)code;
+    }
+    static std::string lower(const std::string& s) {
+        std::string __ret(s);
+        for(size_t i = 0; i < __ret.size(); i++){
+            __ret[i] = (char)std::tolower((unsigned char)__ret[i]);
+        }
+        return __ret;
+    }
+    static int32_t string_vector_field(const _index_meta& meta, const char* a, const char* b) {
+        int32_t __pos = _meta_directory::field_pos(meta, a);
+        if(__pos < 0 || meta.fields_[__pos].type_ != _data_type::VSTRING){
+            __pos = _meta_directory::field_pos(meta, b);
+        }
+        return __pos >= 0 && meta.fields_[__pos].type_ == _data_type::VSTRING ? __pos : -1;
+    }
+    _layout layout(const _schema_image& image, const _meta_key& key) {
+        _layout __layout = {-1, -1, -1};
+        std::map<_meta_key, _index_meta>::const_iterator it = image.metas.find(key);
+        if(it == image.metas.end()){
+            return __layout;
+        }
+        const std::string& __name = it->second.name_;
+        size_t __sep = __name.rfind("::");
+        __layout.code = string_vector_field(it->second, "code", "codes");
+        __layout.name = string_vector_field(it->second, "name", "names");
+        __layout.type = m_strings.intern(__sep == std::string::npos ? __name : __name.substr(__sep + 2));
+        return __layout;
+    }
+    void put(const _security_entry& entry) {
+        uint64_t __key = key(entry.market, entry.code);
+        boost::unordered_map<uint64_t, uint32_t>::iterator it = m_index.find(__key);
+        if(it != m_index.end()){
+            m_entries[it->second] = entry;
+            return;
+        }
+        m_index[__key] = (uint32_t)m_entries.size();
+        m_entries.push_back(entry);
+        m_lower.push_back(lower(m_strings.values()[entry.code]));
+        m_sorted_valid = false;
+    }
+    // the prefix index is rebuilt once after a batch of add()s
+    void sort() {
+        if(m_sorted_valid){
+            return;
+        }
+        m_sorted.resize(m_entries.size());
+        for(size_t i = 0; i < m_sorted.size(); i++){
+            m_sorted[i] = (uint32_t)i;
+        }
+        std::sort(m_sorted.begin(), m_sorted.end(), [this](uint32_t a, uint32_t b){
+            return m_lower[a] < m_lower[b] || (m_lower[a] == m_lower[b] && a < b);
+        });
+        m_sorted_valid = true;
+    }
+    emscripten::val to_js(const _security_entry& entry) const {
+        const std::vector<std::string>& __strings = m_strings.values();
+        emscripten::val __ret = emscripten::val::object();
+        __ret.set("market", __strings[entry.market]);
+        __ret.set("code", __strings[entry.code]);
+        __ret.set("name", __strings[entry.name]);
+        __ret.set("type", entry.type >= 0 ? __strings[entry.type] : std::string());
+        __ret.set("namespace", entry.ns);
+        __ret.set("metaID", entry.meta_id);
+        return __ret;
+    }
+
+    std::vector<_security_entry> m_entries;
+    std::vector<std::string> m_lower;                   // lower case code per entry
+    boost::unordered_map<uint64_t, uint32_t> m_index;   // (market, code) -> entry
+    std::vector<uint32_t> m_sorted;                     // entries by lower case code
+    bool m_sorted_valid;
+    _string_dict m_strings;
+};
+
+#endif
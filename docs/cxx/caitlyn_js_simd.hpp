@@ -0,0 +1,102 @@
+#ifndef __CAITLYN_JS_SIMD_HPP__
+#define __CAITLYN_JS_SIMD_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+/*
+ * Numeric kernels shared by the native helpers. Built with -msimd128 they
+ * run on 128 bit lanes, otherwise the scalar loops below are used; both
+ * produce identical results.
+ */
+
+inline bool _simd_enabled() {
+#ifdef __wasm_simd128__
+    return true;
+#else
+    return false;
+#endif
+}
+
+// out[i] = in[i] * scale, e.g. fixed point integers to doubles
+inline void __i32_to_f64_scaled(const int32_t* in, double* out, size_t n, double scale) {
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    v128_t __scale = wasm_f64x2_splat(scale);
+    for(; i + 4 <= n; i += 4){
+        v128_t __v = wasm_v128_load(in + i);
+        v128_t __lo = wasm_f64x2_convert_low_i32x4(__v);
+        v128_t __hi = wasm_f64x2_convert_low_i32x4(wasm_i32x4_shuffle(__v, __v, 2, 3, 0, 1));
+        wasm_v128_store(out + i, wasm_f64x2_mul(__lo, __scale));
+        wasm_v128_store(out + i + 2, wasm_f64x2_mul(__hi, __scale));
+    }
+#endif
+    for(; i < n; i++){
+        out[i] = (double)in[i] * scale;
+    }
+}
+
+/*
+ * Copies src over dst and sets bit i of mask for every element that changed.
+ * NaN to NaN does not count as a change. mask is OR-ed into, not cleared.
+ */
+inline void __f64_update_mask(double* dst, const double* src, size_t n, uint8_t* mask) {
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    for(; i + 2 <= n; i += 2){
+        v128_t __a = wasm_v128_load(dst + i);
+        v128_t __b = wasm_v128_load(src + i);
+        v128_t __both_nan = wasm_v128_and(wasm_f64x2_ne(__a, __a), wasm_f64x2_ne(__b, __b));
+        v128_t __changed = wasm_v128_andnot(wasm_f64x2_ne(__a, __b), __both_nan);
+        uint32_t __bits = wasm_i64x2_bitmask(__changed);
+        if(__bits & 1) mask[i >> 3] |= (uint8_t)(1 << (i & 7));
+        if(__bits & 2) mask[(i + 1) >> 3] |= (uint8_t)(1 << ((i + 1) & 7));
+        wasm_v128_store(dst + i, __b);
+    }
+#endif
+    for(; i < n; i++){
+        double __a = dst[i];
+        double __b = src[i];
+        if(__a != __b && !(__a != __a && __b != __b)){
+            mask[i >> 3] |= (uint8_t)(1 << (i & 7));
+        }
+        dst[i] = __b;
+    }
+}
+
+// out[i] = a[i] - b[i]
+inline void __f64_sub(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    for(; i + 2 <= n; i += 2){
+        wasm_v128_store(out + i, wasm_f64x2_sub(wasm_v128_load(a + i), wasm_v128_load(b + i)));
+    }
+#endif
+    for(; i < n; i++){
+        out[i] = a[i] - b[i];
+    }
+}
+
+// upper[i] = mid[i] + k * dev[i], lower[i] = mid[i] - k * dev[i]
+inline void __f64_band(const double* mid, const double* dev, double k, double* upper, double* lower, size_t n) {
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    v128_t __k = wasm_f64x2_splat(k);
+    for(; i + 2 <= n; i += 2){
+        v128_t __m = wasm_v128_load(mid + i);
+        v128_t __d = wasm_f64x2_mul(wasm_v128_load(dev + i), __k);
+        wasm_v128_store(upper + i, wasm_f64x2_add(__m, __d));
+        wasm_v128_store(lower + i, wasm_f64x2_sub(__m, __d));
+    }
+#endif
+    for(; i < n; i++){
+        double __d = dev[i] * k;
+        upper[i] = mid[i] + __d;
+        lower[i] = mid[i] - __d;
+    }
+}
+
+#endif
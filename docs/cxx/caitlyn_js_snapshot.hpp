@@ -0,0 +1,323 @@
+#ifndef __CAITLYN_JS_SNAPSHOT_HPP__
+#define __CAITLYN_JS_SNAPSHOT_HPP__
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <emscripten/bind.h>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_meta.hpp>
+#include <caitlyn_js_simd.hpp>
+
+/*
+ * Latest rows of one meta revision. Numeric fields (INT, INT64, DOUBLE) live in a
+ * row-major Float64 matrix so a row never moves once created; string and
+ * vector fields stay on the latest StructValue of the row.
+ */
+struct _snapshot_table {
+    uint32_t ns;
+    uint32_t id;
+    uint32_t revision;
+    uint32_t generation;    // store wide layout() count, rows of another generation are gone
+    boost::shared_ptr<const _decode_plan> plan;
+    std::vector<int32_t> pos;
+    std::vector<uint8_t> codes;
+    std::vector<std::string> names;
+    std::vector<double> values;
+    std::vector<int64_t> time_tags;
+    std::vector<std::string> markets;
+    std::vector<std::string> stock_codes;
+    std::vector<int32_t> granularities;
+    std::vector<_sv_ptr> latest;
+    std::vector<uint32_t> stamps;
+    std::vector<uint32_t> created;
+    std::vector<uint8_t> masks;
+    boost::unordered_map<std::string, int32_t> rows;
+
+    size_t width() const {
+        return pos.size();
+    }
+    // bytes of the per-row field change mask
+    size_t mask_bytes() const {
+        return (width() + 7) / 8;
+    }
+    size_t row_count() const {
+        return time_tags.size();
+    }
+    void layout(const boost::shared_ptr<const _decode_plan>& layout_plan, uint32_t layout_generation) {
+        plan = layout_plan;
+        ns = plan->ns();
+        id = plan->id();
+        revision = plan->revision();
+        generation = layout_generation;
+        pos.clear();
+        codes.clear();
+        names.clear();
+        const std::vector<_plan_op>& __ops = plan->ops();
+        for(size_t i = 0; i < __ops.size(); i++){
+            if(__ops[i].code == PLAN_INT || __ops[i].code == PLAN_INT64 || __ops[i].code == PLAN_DOUBLE){
+                pos.push_back(__ops[i].pos);
+                codes.push_back(__ops[i].code);
+                names.push_back(__ops[i].name);
+            }
+        }
+        values.clear();
+        time_tags.clear();
+        markets.clear();
+        stock_codes.clear();
+        granularities.clear();
+        latest.clear();
+        stamps.clear();
+        created.clear();
+        masks.clear();
+        rows.clear();
+    }
+};
+
+/*
+ * Latest value state of subscriptions, keyed by
+ * (namespace, metaID, market, code, granularity).
+ * apply() folds a decoded ATSubscribeSVRes batch into the tables in place and
+ * records which rows it touched; empty fields keep their previous value.
+ * Each meta revision has a table of its own, so records of several revisions
+ * of one meta coexist. A table is only relaid out, dropping its rows and
+ * their entries in changed(), when a schema update replaces its revision
+ * with another field layout.
+ * Every touched row also carries a bit mask of the fields whose value
+ * changed during that apply(), which the delta encoder builds on.
+ * values()/timeTags()/changed() are views over WASM memory: they are only
+ * valid until the next apply() and must be re-acquired after it.
+ */
+class _subscription_snapshot_store {
+public:
+    _subscription_snapshot_store():m_epoch(0), m_layouts(0) {}
+
+    size_t apply(_at_subscribe_sv_res& res) {
+        std::vector<_sv_ptr> __values = _get_sub_sv_values(res);
+        _schema_image_ptr __image = _meta_directory::instance().image();
+        m_changed.clear();
+        m_epoch++;
+        for(size_t i = 0; i < __values.size(); i++){
+            _sv& __sv = *__values[i];
+            int32_t __table = table_for(*__image, __sv);
+            if(__table < 0){
+                continue;
+            }
+            _snapshot_table& __t = m_tables[__table];
+            int32_t __row = row_for(__t, __sv, m_epoch);
+            if(__t.stamps[__row] != m_epoch){
+                __t.stamps[__row] = m_epoch;
+                std::fill(__t.masks.begin() + __row * __t.mask_bytes(), __t.masks.begin() + (__row + 1) * __t.mask_bytes(), 0);
+                m_changed.push_back(__table);
+                m_changed.push_back(__row);
+            }
+            write_row(__t, __row, __values[i]);
+        }
+        return m_changed.size() / 2;
+    }
+
+    // (table, row) pairs touched by the last apply()
+    emscripten::val changed() const {
+        return emscripten::val(emscripten::typed_memory_view(m_changed.size(), m_changed.data()));
+    }
+    size_t table_count() const {
+        return m_tables.size();
+    }
+    // table of the highest revision of a meta applied so far, -1 when none
+    int32_t table_of(uint32_t ns, uint32_t id) const {
+        std::map<_plan_key, int32_t>::const_iterator it = m_index.lower_bound(_plan_key(_meta_key(ns, id), 0));
+        int32_t __table = -1;
+        for(; it != m_index.end() && it->first.first == _meta_key(ns, id); ++it){
+            __table = it->second;
+        }
+        return __table;
+    }
+    int32_t table_of_revision(uint32_t ns, uint32_t id, uint32_t revision) const {
+        std::map<_plan_key, int32_t>::const_iterator it = m_index.find(_plan_key(_meta_key(ns, id), revision));
+        return it == m_index.end() ? -1 : it->second;
+    }
+    // row in the table_of(ns, id) table
+    int32_t find(uint32_t ns, uint32_t id, const std::string& market, const std::string& code, int32_t granularity) const {
+        int32_t __table = table_of(ns, id);
+        if(__table < 0){
+            return -1;
+        }
+        const _snapshot_table& __t = m_tables[__table];
+        boost::unordered_map<std::string, int32_t>::const_iterator it = __t.rows.find(row_key(market, code, granularity));
+        return it == __t.rows.end() ? -1 : it->second;
+    }
+    // {namespace, metaID, revision, rows, width, fields}
+    emscripten::val table_info(size_t table) const {
+        if(table >= m_tables.size()){
+            return emscripten::val::null();
+        }
+        const _snapshot_table& __t = m_tables[table];
+        emscripten::val __ret = emscripten::val::object();
+        emscripten::val __fields = emscripten::val::array();
+        for(size_t i = 0; i < __t.names.size(); i++){
+            __fields.set(i, __t.names[i]);
+        }
+        __ret.set("namespace", __t.ns);
+        __ret.set("metaID", __t.id);
+        __ret.set("revision", __t.revision);
+        __ret.set("rows", __t.row_count());
+        __ret.set("width", __t.width());
+        __ret.set("fields", __fields);
+        return __ret;
+    }
+    // rows * width doubles, row r starts at r * width
+    emscripten::val values(size_t table) const {
+        if(table >= m_tables.size()){
+            return emscripten::val::null();
+        }
+        return emscripten::val(emscripten::typed_memory_view(m_tables[table].values.size(), m_tables[table].values.data()));
+    }
+    emscripten::val time_tags(size_t table) const {
+        if(table >= m_tables.size()){
+            return emscripten::val::null();
+        }
+        return emscripten::val(emscripten::typed_memory_view(m_tables[table].time_tags.size(), m_tables[table].time_tags.data()));
+    }
+    // single row as a copy, safe to keep across apply()
+    emscripten::val row_values(size_t table, size_t row) const {
+        if(table >= m_tables.size() || row >= m_tables[table].row_count()){
+            return emscripten::val::null();
+        }
+        const _snapshot_table& __t = m_tables[table];
+        emscripten::val __ret = emscripten::val::global("Float64Array").new_(__t.width());
+        if(__t.width()){
+            __ret.call<void>("set", emscripten::val(emscripten::typed_memory_view(__t.width(), &__t.values[row * __t.width()])));
+        }
+        return __ret;
+    }
+    // {market, code, granularity, timeTag}
+    emscripten::val row_key_of(size_t table, size_t row) const {
+        if(table >= m_tables.size() || row >= m_tables[table].row_count()){
+            return emscripten::val::null();
+        }
+        const _snapshot_table& __t = m_tables[table];
+        emscripten::val __ret = emscripten::val::object();
+        __ret.set("market", __t.markets[row]);
+        __ret.set("code", __t.stock_codes[row]);
+        __ret.set("granularity", __t.granularities[row]);
+        __ret.set("timeTag", __t.time_tags[row]);
+        return __ret;
+    }
+    // latest StructValue of the row, for string and vector fields
+    _sv_ptr latest(size_t table, size_t row) const {
+        if(table >= m_tables.size() || row >= m_tables[table].row_count()){
+            return _sv_ptr();
+        }
+        return m_tables[table].latest[row];
+    }
+    // native access for the delta encoder
+    const std::vector<_snapshot_table>& tables() const {
+        return m_tables;
+    }
+    const std::vector<int32_t>& changed_rows() const {
+        return m_changed;
+    }
+    uint32_t epoch() const {
+        return m_epoch;
+    }
+    void clear() {
+        m_tables.clear();
+        m_index.clear();
+        m_changed.clear();
+    }
+private:
+    static std::string row_key(const std::string& market, const std::string& code, int32_t granularity) {
+        std::string __key(market);
+        __key.push_back('\x01');
+        __key.append(code);
+        __key.push_back('\x01');
+        __key.append(std::to_string(granularity));
+        return __key;
+    }
+
+    // table of the revision sv was encoded with, -1 when that revision is not loaded
+    int32_t table_for(const _schema_image& image, _sv& sv) {
+        _plan_key __key(_meta_key((uint32_t)sv.getNamespace(), (uint32_t)sv.getMetaID()), (uint32_t)sv.getRevision());
+        std::map<_plan_key, boost::shared_ptr<const _decode_plan> >::const_iterator __plan = image.plans.find(__key);
+        if(__plan == image.plans.end()){
+            return -1;
+        }
+        std::map<_plan_key, int32_t>::iterator it = m_index.find(__key);
+        if(it == m_index.end()){
+            it = m_index.insert(std::make_pair(__key, (int32_t)m_tables.size())).first;
+            m_tables.push_back(_snapshot_table());
+            m_tables.back().layout(__plan->second, ++m_layouts);
+        }else if(m_tables[it->second].plan != __plan->second){
+            // plans are shared between images, a new one means the revision was replaced
+            m_tables[it->second].layout(__plan->second, ++m_layouts);
+            drop_changed(it->second);
+        }
+        return it->second;
+    }
+    // (table, row) pairs of a table relaid out mid-batch name rows that are gone
+    void drop_changed(int32_t table) {
+        size_t __out = 0;
+        for(size_t i = 0; i + 1 < m_changed.size(); i += 2){
+            if(m_changed[i] != table){
+                m_changed[__out++] = m_changed[i];
+                m_changed[__out++] = m_changed[i + 1];
+            }
+        }
+        m_changed.resize(__out);
+    }
+
+    static int32_t row_for(_snapshot_table& t, _sv& sv, uint32_t epoch) {
+        std::string __key = row_key(sv.getMarket(), sv.getStockCode(), (int32_t)sv.getGranularity());
+        boost::unordered_map<std::string, int32_t>::iterator it = t.rows.find(__key);
+        if(it != t.rows.end()){
+            return it->second;
+        }
+        int32_t __row = (int32_t)t.row_count();
+        t.rows[__key] = __row;
+        t.values.resize(t.values.size() + t.width(), std::numeric_limits<double>::quiet_NaN());
+        t.time_tags.push_back(0);
+        t.markets.push_back(sv.getMarket());
+        t.stock_codes.push_back(sv.getStockCode());
+        t.granularities.push_back((int32_t)sv.getGranularity());
+        t.latest.push_back(_sv_ptr());
+        t.stamps.push_back(0);
+        t.created.push_back(epoch);
+        t.masks.resize(t.masks.size() + t.mask_bytes(), 0);
+        return __row;
+    }
+
+    // gathers the update into a scratch row, then diffs and stores it in one pass
+    void write_row(_snapshot_table& t, int32_t row, const _sv_ptr& ptr) {
+        _sv& __sv = *ptr;
+        if(t.width()){
+            double* __out = &t.values[row * t.width()];
+            m_scratch.assign(__out, __out + t.width());
+            int32_t __size = (int32_t)__sv.size();
+            for(size_t i = 0; i < t.width(); i++){
+                int32_t __pos = t.pos[i];
+                if(__pos >= __size || __sv.isEmpty(__pos)){
+                    continue;
+                }
+                if(t.codes[i] == PLAN_DOUBLE) m_scratch[i] = __sv.getDouble(__pos);
+                else if(t.codes[i] == PLAN_INT) m_scratch[i] = (double)__sv.getInt(__pos);
+                else m_scratch[i] = (double)__sv.getInt64(__pos);
+            }
+            __f64_update_mask(__out, &m_scratch[0], t.width(), &t.masks[row * t.mask_bytes()]);
+        }
+        t.time_tags[row] = (int64_t)__sv.getTimeTag();
+        t.latest[row] = ptr;
+    }
+
+    uint32_t m_epoch;
+    uint32_t m_layouts;     // not reset by clear(), so encoders notice reused table indices
+    std::vector<_snapshot_table> m_tables;
+    std::map<_plan_key, int32_t> m_index;
+    std::vector<int32_t> m_changed;
+    std::vector<double> m_scratch;
+};
+
+#endif
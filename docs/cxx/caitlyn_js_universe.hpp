@@ -0,0 +1,219 @@
+#ifndef __CAITLYN_JS_UNIVERSE_HPP__
+#define __CAITLYN_JS_UNIVERSE_HPP__
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_schema.hpp>
+
+/*
+ * Universe seeds cache file, shared by the WASM and native builds:
+ *
+ *   'C' 'U' 'N' 'V'  u16 version  u16 reserved  u32 length  u32 fnv1a(payload)  payload
+ *   payload: u16+schema key, u32 count, count * (u16+namespace, u16+market,
+ *            u16+qualified name, u32 revision, i32 trade day, u32+seeds)
+ *
+ * little endian, u16+/u32+ are length prefixed bytes. seeds is the
+ * ATUniverseSeedsRes payload as received: it is already the compact encoding
+ * the decoder reads, and it stays valid for as long as the schema it was
+ * compressed with, so the file is tied to a schema key and a different key
+ * drops every entry. A (namespace, market, qualified name) whose revision in
+ * ATUniverseRes matches its entry needs no ATUniverseSeedsReq.
+ */
+const uint8_t __UNIVERSE_CACHE_MAGIC[4] = {'C', 'U', 'N', 'V'};
+const uint16_t __UNIVERSE_CACHE_VERSION = 1;
+const size_t __UNIVERSE_CACHE_HEADER = 16;
+const size_t __UNIVERSE_CACHE_MAX_STRING = 0xffff;
+
+struct _universe_seeds {
+    uint32_t revision;
+    int32_t trade_day;
+    const uint8_t* data;                        // into owned or the loaded file
+    size_t size;
+    boost::shared_ptr<const std::string> owned; // set for put() entries
+};
+
+class _universe_cache {
+public:
+    // namespace, market, qualified name
+    typedef std::pair<std::pair<std::string, std::string>, std::string> _key;
+
+    // a different key drops the entries compressed with the previous schema; false for a key too long to save
+    bool set_schema_key(const std::string& key) {
+        if(key.size() > __UNIVERSE_CACHE_MAX_STRING){
+            return false;
+        }
+        if(key != m_schema_key){
+            clear();
+            m_schema_key = key;
+        }
+        return true;
+    }
+    std::string schema_key() const {
+        return m_schema_key;
+    }
+    /*
+     * Replaces the entries with those of a cache file. Entries point into data,
+     * which backing keeps alive (a copy, or the mapping of the file). false,
+     * leaving the cache untouched, for a corrupt file or another schema key.
+     */
+    bool load(const uint8_t* data, size_t size, const boost::shared_ptr<const void>& backing) {
+        if(size < __UNIVERSE_CACHE_HEADER || std::memcmp(data, __UNIVERSE_CACHE_MAGIC, 4) != 0){
+            return false;
+        }
+        uint16_t __version = (uint16_t)(data[4] | (data[5] << 8));
+        uint32_t __length = __snapshot_get_u32(data + 8);
+        if(__version != __UNIVERSE_CACHE_VERSION || __length != size - __UNIVERSE_CACHE_HEADER){
+            return false;
+        }
+        const uint8_t* __p = data + __UNIVERSE_CACHE_HEADER;
+        const uint8_t* __end = __p + __length;
+        if(__fnv1a(__p, __length) != __snapshot_get_u32(data + 12)){
+            return false;
+        }
+        std::string __schema_key;
+        uint32_t __count = 0;
+        if(!get_string(__p, __end, __schema_key) || !get_u32(__p, __end, __count)){
+            return false;
+        }
+        if(!m_schema_key.empty() && __schema_key != m_schema_key){
+            return false;
+        }
+        std::map<_key, _universe_seeds> __entries;
+        for(uint32_t i = 0; i < __count; i++){
+            _key __key;
+            _universe_seeds __seeds;
+            uint32_t __trade_day = 0;
+            uint32_t __size = 0;
+            if(!get_string(__p, __end, __key.first.first) || !get_string(__p, __end, __key.first.second)
+                || !get_string(__p, __end, __key.second) || !get_u32(__p, __end, __seeds.revision)
+                || !get_u32(__p, __end, __trade_day) || !get_u32(__p, __end, __size) || (size_t)(__end - __p) < __size){
+                return false;
+            }
+            __seeds.trade_day = (int32_t)__trade_day;
+            __seeds.data = __p;
+            __seeds.size = __size;
+            __p += __size;
+            __entries[__key] = __seeds;
+        }
+        m_entries.swap(__entries);
+        m_backing = backing;
+        m_schema_key = __schema_key;
+        return true;
+    }
+    // set_schema_key() and put() keep every string within a u16 length, so this always fits
+    void save(ByteArray& out) const {
+        ByteArray __payload;
+        put_string(__payload, m_schema_key);
+        put_u32(__payload, (uint32_t)m_entries.size());
+        for(std::map<_key, _universe_seeds>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it){
+            put_string(__payload, it->first.first.first);
+            put_string(__payload, it->first.first.second);
+            put_string(__payload, it->first.second);
+            put_u32(__payload, it->second.revision);
+            put_u32(__payload, (uint32_t)it->second.trade_day);
+            put_u32(__payload, (uint32_t)it->second.size);
+            __payload.insert(__payload.end(), it->second.data, it->second.data + it->second.size);
+        }
+        out.resize(__UNIVERSE_CACHE_HEADER + __payload.size());
+        uint8_t* __p = &out[0];
+        std::memcpy(__p, __UNIVERSE_CACHE_MAGIC, 4);
+        __p[4] = (uint8_t)__UNIVERSE_CACHE_VERSION;
+        __p[5] = (uint8_t)(__UNIVERSE_CACHE_VERSION >> 8);
+        __p[6] = 0;
+        __p[7] = 0;
+        __snapshot_put_u32(__p + 8, (uint32_t)__payload.size());
+        __snapshot_put_u32(__p + 12, __fnv1a(&__payload[0], __payload.size()));
+        std::memcpy(__p + __UNIVERSE_CACHE_HEADER, &__payload[0], __payload.size());
+    }
+    // 0 when absent
+    const _universe_seeds* find(const std::string& ns, const std::string& market, const std::string& qualified_name) const {
+        std::map<_key, _universe_seeds>::const_iterator it = m_entries.find(key(ns, market, qualified_name));
+        return it == m_entries.end() ? 0 : &it->second;
+    }
+    // true when the cached seeds are those of revision on trade_day
+    bool is_fresh(const std::string& ns, const std::string& market, const std::string& qualified_name,
+        uint32_t revision, int32_t trade_day) const
+    {
+        const _universe_seeds* __seeds = find(ns, market, qualified_name);
+        return __seeds && __seeds->revision == revision && __seeds->trade_day == trade_day;
+    }
+    // false, caching nothing, when a key string is too long for the file
+    bool put(const std::string& ns, const std::string& market, const std::string& qualified_name,
+        uint32_t revision, int32_t trade_day, const std::string& payload)
+    {
+        if(ns.size() > __UNIVERSE_CACHE_MAX_STRING || market.size() > __UNIVERSE_CACHE_MAX_STRING
+            || qualified_name.size() > __UNIVERSE_CACHE_MAX_STRING){
+            return false;
+        }
+        _universe_seeds& __seeds = m_entries[key(ns, market, qualified_name)];
+        __seeds.owned = boost::make_shared<const std::string>(payload);
+        __seeds.revision = revision;
+        __seeds.trade_day = trade_day;
+        __seeds.data = (const uint8_t*)__seeds.owned->data();
+        __seeds.size = __seeds.owned->size();
+        return true;
+    }
+    bool remove(const std::string& ns, const std::string& market, const std::string& qualified_name) {
+        return m_entries.erase(key(ns, market, qualified_name)) > 0;
+    }
+    size_t size() const {
+        return m_entries.size();
+    }
+    // seeds payload bytes held
+    size_t bytes() const {
+        size_t __ret = 0;
+        for(std::map<_key, _universe_seeds>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it){
+            __ret += it->second.size;
+        }
+        return __ret;
+    }
+    void clear() {
+        m_entries.clear();
+        m_backing.reset();
+    }
+private:
+    static _key key(const std::string& ns, const std::string& market, const std::string& qualified_name) {
+        return _key(std::make_pair(ns, market), qualified_name);
+    }
+    static void put_u32(ByteArray& out, uint32_t v) {
+        size_t __n = out.size();
+        out.resize(__n + 4);
+        __snapshot_put_u32(&out[__n], v);
+    }
+    static void put_string(ByteArray& out, const std::string& s) {
+        out.push_back((uint8_t)s.size());
+        out.push_back((uint8_t)(s.size() >> 8));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+    static bool get_u32(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+        if(end - p < 4){
+            return false;
+        }
+        v = __snapshot_get_u32(p);
+        p += 4;
+        return true;
+    }
+    static bool get_string(const uint8_t*& p, const uint8_t* end, std::string& s) {
+        if(end - p < 2){
+            return false;
+        }
+        size_t __len = (size_t)(p[0] | (p[1] << 8));
+        p += 2;
+        if((size_t)(end - p) < __len){
+            return false;
+        }
+        s.assign((const char*)p, __len);
+        p += __len;
+        return true;
+    }
+
+    std::string m_schema_key;
+    std::map<_key, _universe_seeds> m_entries;
+    boost::shared_ptr<const void> m_backing;    // storage of loaded entries
+};
+
+#endif
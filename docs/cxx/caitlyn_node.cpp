@@ -0,0 +1,99 @@
+/*
+ * Native Node.js (N-API) build of the caitlyn protocol bindings.
+ *
+ * Built from the same caitlyn_js.cpp as caitlyn_js.wasm: with docs/cxx/node
+ * ahead on the include path, <emscripten/bind.h> resolves to
+ * caitlyn_node_bind.hpp, which registers the EMSCRIPTEN_BINDINGS(test) block
+ * as N-API classes and functions. The addon therefore exports the same
+ * classes, methods, properties, enums and constants as the WASM module, and
+ * the backend can switch between the two (see CaitlynClientConnection
+ * loadWasmModule and WasmService, option backend: 'native').
+ *
+ * Only node specific extras live here: loading files through a read-only
+ * mapping instead of copying them into the module first.
+ *
+ * Build: backend/native/binding.gyp (npm run build:native in backend/).
+ */
+#include <corestdafx.h>
+#include <boost/cstdint.hpp>
+#include <boost/make_shared.hpp>
+#include <precompile/types.hpp>
+#include <string>
+#include <emscripten/bind.h>
+#include <protocol/caitlyn_tm_protocol_entity.hpp>
+#include <protocol/caitlyn_tm_comm_protocol.hpp>
+#include <go/caitlyn_go_codec.hpp>
+
+#include <caitlyn_js_types.hpp>
+#include <caitlyn_js_sv.hpp>
+#include <caitlyn_js_schema.hpp>
+#include <caitlyn_js_universe.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace emscripten;
+
+// releases the mapping of a loaded cache file with the last entry pointing into it
+struct _node_unmap {
+    size_t size;
+    void operator()(void* p) const {
+        munmap(p, size);
+    }
+};
+
+// read-only mapping of a whole file, null when it is missing or empty
+inline void* __node_map_file(const std::string& path, size_t& size) {
+    void* __ret = 0;
+    int __fd = open(path.c_str(), O_RDONLY);
+    struct stat __st;
+    if(__fd >= 0 && fstat(__fd, &__st) == 0 && __st.st_size > 0){
+        void* __map = mmap(0, (size_t)__st.st_size, PROT_READ, MAP_PRIVATE, __fd, 0);
+        if(__map != MAP_FAILED){
+            __ret = __map;
+            size = (size_t)__st.st_size;
+        }
+    }
+    if(__fd >= 0){
+        close(__fd);
+    }
+    return __ret;
+}
+
+// IndexSchema.loadSnapshotFile(path): decodes from a mapping of the snapshot file
+bool _load_index_schema_snapshot_file(_index_schema& schema, const std::string& path){
+    size_t __size = 0;
+    void* __map = __node_map_file(path, __size);
+    if(!__map){
+        return false;
+    }
+    bool __ok = _load_schema_snapshot(schema, (const uint8_t*)__map, __size);
+    munmap(__map, __size);
+    return __ok;
+}
+
+// UniverseCache.loadFile(path): entries point straight into the mapping, kept while any is cached
+bool _universe_cache_load_file(_universe_cache& cache, const std::string& path){
+    size_t __size = 0;
+    void* __map = __node_map_file(path, __size);
+    if(!__map){
+        return false;
+    }
+    _node_unmap __unmap = {__size};
+    boost::shared_ptr<void> __backing(__map, __unmap);
+    return cache.load((const uint8_t*)__map, __size, __backing);
+}
+
+EMSCRIPTEN_BINDINGS(node) {
+    class_<_index_schema>("IndexSchema")
+        .function("loadSnapshotFile", &_load_index_schema_snapshot_file)
+        ;
+    class_<_universe_cache>("UniverseCache")
+        .function("loadFile", &_universe_cache_load_file)
+        ;
+}
+
+NAPI_MODULE_INIT() {
+    return emscripten::__node_export(env, exports);
+}
@@ -0,0 +1,1794 @@
+#ifndef __CAITLYN_NODE_BIND_HPP__
+#define __CAITLYN_NODE_BIND_HPP__
+
+/*
+ * emscripten/bind.h on N-API, for the native addon build of caitlyn_js.cpp.
+ *
+ * EMSCRIPTEN_BINDINGS blocks record their class_/function/enum_/constant/
+ * register_* declarations here, and __node_export() turns them into JS
+ * classes and functions on the addon's exports at load time. The addon thus
+ * registers exactly what caitlyn_js.wasm registers, following embind for
+ * names, constructor and function overloads (chosen by argument count),
+ * property accessors, base classes, delete()/clone()/isDeleted(), enum
+ * objects ({value}, Type.values) and value_object/value_array conversions.
+ *
+ * Differences from the WASM build:
+ * - 64-bit integers come back as Numbers when they fit in 2^53, BigInt
+ *   otherwise (int64_t and size_t are the same type on LP64, and size()
+ *   has to stay a Number). Arguments accept Number, BigInt or a decimal
+ *   string.
+ * - typed_memory_view() is an external ArrayBuffer over native memory. As
+ *   with WASM views it is only valid until the native buffer changes.
+ * - val handles live for the duration of one call into the addon.
+ * - C++ exceptions become JS Errors (TypeError for bad arguments) at the
+ *   callback boundary instead of aborting the process.
+ */
+#ifndef NAPI_VERSION
+#define NAPI_VERSION 8
+#endif
+#include <node_api.h>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define EMSCRIPTEN_KEEPALIVE
+
+namespace emscripten {
+
+// a JS exception is already pending in the env
+struct __node_pending {};
+
+struct __node_type_error : public std::runtime_error {
+    explicit __node_type_error(const std::string& what):std::runtime_error(what) {}
+};
+
+inline napi_env& __node_current_env() {
+    static thread_local napi_env __env = 0;
+    return __env;
+}
+
+// env of the call in progress, used by val and the conversions
+inline napi_env __node_env() {
+    napi_env __env = __node_current_env();
+    if(!__env){
+        throw std::logic_error("emscripten::val used outside a call into the addon");
+    }
+    return __env;
+}
+
+class __node_scope {
+public:
+    explicit __node_scope(napi_env env):m_prev(__node_current_env()) {
+        __node_current_env() = env;
+    }
+    ~__node_scope() {
+        __node_current_env() = m_prev;
+    }
+private:
+    napi_env m_prev;
+};
+
+inline void __node_check(napi_env env, napi_status status) {
+    if(status == napi_ok){
+        return;
+    }
+    const napi_extended_error_info* __info = 0;
+    napi_get_last_error_info(env, &__info);
+    std::string __what = __info && __info->error_message ? __info->error_message : "N-API call failed";
+    bool __pending = false;
+    napi_is_exception_pending(env, &__pending);
+    if(__pending){
+        throw __node_pending();
+    }
+    throw std::runtime_error(__what);
+}
+
+// runs one callback body, turning C++ exceptions into JS ones
+template<typename F>
+napi_value __node_guard(napi_env env, F&& body) {
+    __node_scope __scope(env);
+    try{
+        return body();
+    }catch(const __node_pending&){
+    }catch(const __node_type_error& e){
+        napi_throw_type_error(env, 0, e.what());
+    }catch(const std::exception& e){
+        napi_throw_error(env, 0, e.what());
+    }catch(...){
+        napi_throw_error(env, 0, "unknown native exception");
+    }
+    return 0;
+}
+
+inline napi_valuetype __node_typeof(napi_env env, napi_value v) {
+    napi_valuetype __type = napi_undefined;
+    if(v){
+        __node_check(env, napi_typeof(env, v, &__type));
+    }
+    return __type;
+}
+
+inline napi_value __node_undefined(napi_env env) {
+    napi_value __ret;
+    __node_check(env, napi_get_undefined(env, &__ret));
+    return __ret;
+}
+
+inline napi_value __node_null(napi_env env) {
+    napi_value __ret;
+    __node_check(env, napi_get_null(env, &__ret));
+    return __ret;
+}
+
+inline napi_value __node_global(napi_env env) {
+    napi_value __ret;
+    __node_check(env, napi_get_global(env, &__ret));
+    return __ret;
+}
+
+inline napi_value __node_get(napi_env env, napi_value obj, const char* name) {
+    napi_value __ret;
+    __node_check(env, napi_get_named_property(env, obj, name, &__ret));
+    return __ret;
+}
+
+inline bool __node_is_array(napi_env env, napi_value v) {
+    bool __ret = false;
+    __node_check(env, napi_is_array(env, v, &__ret));
+    return __ret;
+}
+
+inline uint32_t __node_length(napi_env env, napi_value v) {
+    uint32_t __ret = 0;
+    __node_check(env, napi_get_array_length(env, v, &__ret));
+    return __ret;
+}
+
+// short description of a JS value for error messages
+inline std::string __node_describe(napi_env env, napi_value v) {
+    switch(__node_typeof(env, v)){
+    case napi_undefined: return "undefined";
+    case napi_null: return "null";
+    case napi_boolean: return "boolean";
+    case napi_number: return "number";
+    case napi_bigint: return "bigint";
+    case napi_symbol: return "symbol";
+    case napi_function: return "function";
+    case napi_external: return "external";
+    case napi_string: {
+        char __buf[64];
+        size_t __n = 0;
+        napi_get_value_string_utf8(env, v, __buf, sizeof(__buf), &__n);
+        return "\"" + std::string(__buf, __n) + "\"";
+    }
+    default: return "object";
+    }
+}
+
+/*
+ * Registry filled by the EMSCRIPTEN_BINDINGS blocks
+ */
+typedef std::function<napi_value(napi_env, napi_value, napi_value*)> __node_invoker;
+
+// one JS name, overloads chosen by argument count
+struct __node_overloads {
+    std::string name;
+    std::string label;
+    bool method;
+    std::map<size_t, __node_invoker> by_arity;
+};
+
+struct __node_property {
+    std::string name;
+    std::function<napi_value(napi_env, napi_value)> get;
+    std::function<void(napi_env, napi_value, napi_value)> set;
+};
+
+// value_object field / value_array element
+struct __node_field {
+    std::string name;
+    std::function<napi_value(napi_env, const void*)> get;
+    std::function<void(napi_env, napi_value, void*)> set;
+};
+
+// native object and the reference keeping it alive (empty for borrowed pointers)
+struct __node_holder {
+    void* ptr;
+    boost::shared_ptr<void> owner;
+};
+
+typedef std::function<__node_holder(napi_env, napi_value*)> __node_factory;
+
+enum __node_kind {
+    __NODE_CLASS,
+    __NODE_VALUE_OBJECT,
+    __NODE_VALUE_ARRAY
+};
+
+struct __node_class {
+    std::string name;
+    std::type_index type;
+    __node_kind kind;
+    const std::type_info* base_type;
+    const __node_class* base;
+    void* (*upcast)(void*);
+    __node_holder (*copy)(const void*);
+    __node_holder (*make)();
+    std::map<size_t, __node_factory> ctors;
+    std::vector<__node_overloads*> methods;
+    std::vector<__node_overloads*> statics;
+    std::vector<__node_property*> props;
+    std::vector<__node_field*> fields;
+
+    __node_class(const char* n, const std::type_info& t, __node_kind k)
+        :name(n), type(t), kind(k), base_type(0), base(0), upcast(0), copy(0), make(0) {}
+};
+
+struct __node_enum {
+    std::string name;
+    std::type_index type;
+    std::vector<std::pair<std::string, int64_t> > values;
+
+    __node_enum(const char* n, const std::type_info& t):name(n), type(t) {}
+};
+
+struct __node_registry {
+    std::vector<void (*)()> bindings;
+    std::vector<__node_class*> classes;
+    std::map<std::type_index, __node_class*> class_by_type;
+    std::vector<__node_enum*> enums;
+    std::map<std::type_index, __node_enum*> enum_by_type;
+    std::vector<__node_overloads*> functions;
+    std::vector<std::pair<std::string, std::function<napi_value(napi_env)> > > constants;
+};
+
+inline __node_registry& __node_reg() {
+    static __node_registry __reg;
+    return __reg;
+}
+
+inline const __node_class* __node_find_class(const std::type_info& type) {
+    std::map<std::type_index, __node_class*>::const_iterator it = __node_reg().class_by_type.find(type);
+    return it == __node_reg().class_by_type.end() ? 0 : it->second;
+}
+
+inline const __node_class* __node_require_class(const std::type_info& type) {
+    const __node_class* __cls = __node_find_class(type);
+    if(!__cls){
+        throw __node_type_error(std::string("Cannot convert unbound type ") + type.name());
+    }
+    return __cls;
+}
+
+inline std::string __node_class_name(const std::type_info& type) {
+    const __node_class* __cls = __node_find_class(type);
+    return __cls ? __cls->name : type.name();
+}
+
+inline void __node_add_overload(std::vector<__node_overloads*>& list, const std::string& name,
+    const std::string& label, bool method, size_t arity, const __node_invoker& invoker)
+{
+    for(size_t i = 0; i < list.size(); i++){
+        if(list[i]->name == name){
+            list[i]->by_arity[arity] = invoker;
+            return;
+        }
+    }
+    __node_overloads* __o = new __node_overloads();
+    __o->name = name;
+    __o->label = label;
+    __o->method = method;
+    __o->by_arity[arity] = invoker;
+    list.push_back(__o);
+}
+
+/*
+ * Per env state: constructors and enum value objects, so the addon also
+ * loads in worker threads
+ */
+struct __node_env_state {
+    std::map<const __node_class*, napi_ref> ctors;
+    std::map<const __node_enum*, std::map<int64_t, napi_ref> > enum_values;
+};
+
+inline __node_env_state& __node_state(napi_env env) {
+    void* __data = 0;
+    __node_check(env, napi_get_instance_data(env, &__data));
+    if(!__data){
+        throw std::logic_error("caitlyn addon used before its exports were created");
+    }
+    return *(__node_env_state*)__data;
+}
+
+inline napi_value __node_ctor_of(napi_env env, const __node_class* cls) {
+    __node_env_state& __state = __node_state(env);
+    std::map<const __node_class*, napi_ref>::const_iterator it = __state.ctors.find(cls);
+    if(it == __state.ctors.end()){
+        throw std::logic_error("class " + cls->name + " is not exported");
+    }
+    napi_value __ret;
+    __node_check(env, napi_get_reference_value(env, it->second, &__ret));
+    return __ret;
+}
+
+/*
+ * Instances: every JS object of a bound class wraps one __node_instance
+ */
+struct __node_instance {
+    const __node_class* type;
+    void* ptr;
+    boost::shared_ptr<void> owner;
+};
+
+inline const napi_type_tag* __node_tag() {
+    static const napi_type_tag __tag = {0x636169746c796e5fULL, 0x6e6f64655f62696eULL};
+    return &__tag;
+}
+
+inline void __node_finalize(napi_env, void* data, void*) {
+    delete (__node_instance*)data;
+}
+
+inline __node_instance* __node_instance_of(napi_env env, napi_value v) {
+    if(__node_typeof(env, v) != napi_object){
+        return 0;
+    }
+    bool __tagged = false;
+    __node_check(env, napi_check_object_type_tag(env, v, __node_tag(), &__tagged));
+    if(!__tagged){
+        return 0;
+    }
+    void* __data = 0;
+    __node_check(env, napi_unwrap(env, v, &__data));
+    return (__node_instance*)__data;
+}
+
+// pointer to the `type` part of the object wrapped by v, walking up base classes
+inline void* __node_cast(napi_env env, napi_value v, const std::type_info& type, boost::shared_ptr<void>* owner = 0) {
+    __node_instance* __inst = __node_instance_of(env, v);
+    if(!__inst){
+        throw __node_type_error("Cannot pass " + __node_describe(env, v) + " as a " + __node_class_name(type));
+    }
+    if(!__inst->ptr){
+        throw std::runtime_error("Cannot pass deleted object as a pointer of type " + __node_class_name(type));
+    }
+    void* __ptr = __inst->ptr;
+    for(const __node_class* __cls = __inst->type; __cls; __cls = __cls->base){
+        if(__cls->type == std::type_index(type)){
+            if(owner){
+                *owner = __inst->owner;
+            }
+            return __ptr;
+        }
+        if(!__cls->upcast){
+            break;
+        }
+        __ptr = __cls->upcast(__ptr);
+    }
+    throw __node_type_error("Expected null or instance of " + __node_class_name(type) + ", got an instance of " + __inst->type->name);
+}
+
+// new JS object of class cls around ptr
+inline napi_value __node_new(napi_env env, const __node_class* cls, void* ptr, const boost::shared_ptr<void>& owner) {
+    __node_instance __inst = {cls, ptr, owner};
+    napi_value __ext;
+    __node_check(env, napi_create_external(env, &__inst, 0, 0, &__ext));
+    napi_value __ret;
+    __node_check(env, napi_new_instance(env, __node_ctor_of(env, cls), 1, &__ext, &__ret));
+    return __ret;
+}
+
+/*
+ * JS <-> C++ conversions. __node_wire<T>::to_js() converts a value, and
+ * __node_wire<T>::holder converts an argument and keeps what get() refers to.
+ */
+template<typename T, typename Enable = void>
+struct __node_wire;
+
+template<typename T>
+napi_value __node_to_js(napi_env env, const T& v) {
+    return __node_wire<typename std::decay<T>::type>::to_js(env, v);
+}
+
+template<typename A>
+struct __node_arg {
+    typedef typename std::decay<A>::type _decayed;
+    typename __node_wire<_decayed>::holder h;
+
+    __node_arg(napi_env env, napi_value v):h(env, v) {}
+    A get() {
+        return h.get();
+    }
+};
+
+template<typename T>
+struct memory_view {
+    memory_view(size_t n, const T* p):size(n), data(p) {}
+    size_t size;
+    const T* data;
+};
+
+template<typename T>
+memory_view<T> typed_memory_view(size_t size, const T* data) {
+    return memory_view<T>(size, data);
+}
+
+typedef napi_value EM_VAL;
+
+class val {
+public:
+    val():m_handle(0) {}
+    template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, val>::value>::type>
+    explicit val(T&& v):m_handle(__node_to_js(__node_env(), v)) {}
+
+    static val take_ownership(EM_VAL handle) {
+        val __ret;
+        __ret.m_handle = handle;
+        return __ret;
+    }
+    static val null() {
+        return take_ownership(__node_null(__node_env()));
+    }
+    static val undefined() {
+        return take_ownership(__node_undefined(__node_env()));
+    }
+    static val object() {
+        napi_value __ret;
+        __node_check(__node_env(), napi_create_object(__node_env(), &__ret));
+        return take_ownership(__ret);
+    }
+    static val array() {
+        napi_value __ret;
+        __node_check(__node_env(), napi_create_array(__node_env(), &__ret));
+        return take_ownership(__ret);
+    }
+    template<typename T>
+    static val array(const std::vector<T>& v) {
+        val __ret = array();
+        for(size_t i = 0; i < v.size(); i++){
+            __node_check(__node_env(), napi_set_element(__node_env(), __ret.m_handle, (uint32_t)i, __node_to_js(__node_env(), v[i])));
+        }
+        return __ret;
+    }
+    static val global(const char* name = 0) {
+        napi_value __global = __node_global(__node_env());
+        return take_ownership(name ? __node_get(__node_env(), __global, name) : __global);
+    }
+    static val u8string(const char* s) {
+        return val(std::string(s));
+    }
+
+    EM_VAL as_handle() const {
+        return handle();
+    }
+    napi_value handle() const {
+        return m_handle ? m_handle : __node_undefined(__node_env());
+    }
+
+    bool isNull() const { return type() == napi_null; }
+    bool isUndefined() const { return type() == napi_undefined; }
+    bool isNumber() const { return type() == napi_number; }
+    bool isString() const { return type() == napi_string; }
+    bool isTrue() const { return type() == napi_boolean && as<bool>(); }
+    bool isFalse() const { return type() == napi_boolean && !as<bool>(); }
+    bool isArray() const { return m_handle && __node_is_array(__node_env(), m_handle); }
+
+    std::string typeOf() const {
+        switch(type()){
+        case napi_undefined: return "undefined";
+        case napi_null: return "object";
+        case napi_boolean: return "boolean";
+        case napi_number: return "number";
+        case napi_bigint: return "bigint";
+        case napi_string: return "string";
+        case napi_symbol: return "symbol";
+        case napi_function: return "function";
+        default: return "object";
+        }
+    }
+
+    bool hasOwnProperty(const char* key) const {
+        bool __ret = false;
+        __node_check(__node_env(), napi_has_own_property(__node_env(), handle(), val(std::string(key)).handle(), &__ret));
+        return __ret;
+    }
+
+    template<typename K>
+    val operator[](const K& key) const {
+        napi_value __ret;
+        __node_check(__node_env(), napi_get_property(__node_env(), handle(), __node_to_js(__node_env(), key), &__ret));
+        return take_ownership(__ret);
+    }
+
+    template<typename K, typename V>
+    void set(const K& key, const V& v) const {
+        __node_check(__node_env(), napi_set_property(__node_env(), handle(), __node_to_js(__node_env(), key), __node_to_js(__node_env(), v)));
+    }
+
+    template<typename... A>
+    val new_(A&&... args) const {
+        napi_value __argv[sizeof...(A) + 1] = {__node_to_js(__node_env(), args)...};
+        napi_value __ret;
+        __node_check(__node_env(), napi_new_instance(__node_env(), handle(), sizeof...(A), __argv, &__ret));
+        return take_ownership(__ret);
+    }
+
+    template<typename... A>
+    val operator()(A&&... args) const {
+        napi_value __argv[sizeof...(A) + 1] = {__node_to_js(__node_env(), args)...};
+        napi_value __ret;
+        __node_check(__node_env(), napi_call_function(__node_env(), __node_undefined(__node_env()), handle(), sizeof...(A), __argv, &__ret));
+        return take_ownership(__ret);
+    }
+
+    template<typename R = val, typename... A>
+    R call(const char* name, A&&... args) const {
+        napi_value __argv[sizeof...(A) + 1] = {__node_to_js(__node_env(), args)...};
+        napi_value __fn = __node_get(__node_env(), handle(), name);
+        napi_value __ret;
+        __node_check(__node_env(), napi_call_function(__node_env(), handle(), __fn, sizeof...(A), __argv, &__ret));
+        return take_ownership(__ret).template as<R>();
+    }
+
+    template<typename T>
+    T as() const {
+        return __node_arg<T>(__node_env(), handle()).get();
+    }
+
+private:
+    napi_valuetype type() const {
+        return m_handle ? __node_typeof(__node_env(), m_handle) : napi_undefined;
+    }
+
+    napi_value m_handle;
+};
+
+template<>
+inline void val::as<void>() const {
+}
+
+template<>
+struct __node_wire<val> {
+    static napi_value to_js(napi_env, const val& v) {
+        return v.handle();
+    }
+    struct holder {
+        holder(napi_env, napi_value v):value(val::take_ownership(v)) {}
+        val& get() { return value; }
+        val value;
+    };
+};
+
+// numbers: integers past 2^53 go out as BigInt, 64-bit arguments also take decimal strings
+template<typename T>
+T __node_number(napi_env env, napi_value v) {
+    switch(__node_typeof(env, v)){
+    case napi_number: {
+        double __d = 0;
+        __node_check(env, napi_get_value_double(env, v, &__d));
+        if(std::is_integral<T>::value){
+            if(!std::isfinite(__d)){
+                return T();
+            }
+            return __d < 0 ? (T)(int64_t)__d : (T)(uint64_t)__d;
+        }
+        return (T)__d;
+    }
+    case napi_bigint: {
+        bool __lossless = false;
+        if(std::is_signed<T>::value){
+            int64_t __i = 0;
+            __node_check(env, napi_get_value_bigint_int64(env, v, &__i, &__lossless));
+            return (T)__i;
+        }
+        uint64_t __u = 0;
+        __node_check(env, napi_get_value_bigint_uint64(env, v, &__u, &__lossless));
+        return (T)__u;
+    }
+    case napi_string:
+        if(std::is_integral<T>::value && sizeof(T) == 8){
+            char __buf[32];
+            size_t __n = 0;
+            __node_check(env, napi_get_value_string_utf8(env, v, __buf, sizeof(__buf), &__n));
+            char* __end = 0;
+            errno = 0;
+            T __ret = std::is_signed<T>::value ? (T)std::strtoll(__buf, &__end, 10) : (T)std::strtoull(__buf, &__end, 10);
+            bool __digits = __n > 0 && (std::isdigit((unsigned char)__buf[0]) || (__buf[0] == '-' && std::is_signed<T>::value && __n > 1));
+            if(__digits && errno == 0 && __end == __buf + __n){
+                return __ret;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    throw __node_type_error("Cannot convert " + __node_describe(env, v) + " to a number");
+}
+
+template<typename T>
+struct __node_wire<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type> {
+    static napi_value to_js(napi_env env, T v) {
+        napi_value __ret;
+        const double __safe = 9007199254740991.0;
+        if(std::is_integral<T>::value && sizeof(T) == 8 && ((double)v > __safe || (double)v < -__safe)){
+            if(std::is_signed<T>::value){
+                __node_check(env, napi_create_bigint_int64(env, (int64_t)v, &__ret));
+            }else{
+                __node_check(env, napi_create_bigint_uint64(env, (uint64_t)v, &__ret));
+            }
+            return __ret;
+        }
+        __node_check(env, napi_create_double(env, (double)v, &__ret));
+        return __ret;
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):value(__node_number<T>(env, v)) {}
+        T& get() { return value; }
+        T value;
+    };
+};
+
+template<>
+struct __node_wire<bool> {
+    static napi_value to_js(napi_env env, bool v) {
+        napi_value __ret;
+        __node_check(env, napi_get_boolean(env, v, &__ret));
+        return __ret;
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):value(false) {
+            napi_value __b;
+            __node_check(env, napi_coerce_to_bool(env, v, &__b));
+            __node_check(env, napi_get_value_bool(env, __b, &value));
+        }
+        bool& get() { return value; }
+        bool value;
+    };
+};
+
+// strings: JS strings as UTF-8, ArrayBuffer and (U)Int8Array as raw bytes, as embind
+inline std::string __node_string(napi_env env, napi_value v) {
+    if(__node_typeof(env, v) == napi_string){
+        size_t __n = 0;
+        __node_check(env, napi_get_value_string_utf8(env, v, 0, 0, &__n));
+        std::vector<char> __buf(__n + 1);
+        __node_check(env, napi_get_value_string_utf8(env, v, &__buf[0], __buf.size(), &__n));
+        return std::string(&__buf[0], __n);
+    }
+    bool __is = false;
+    __node_check(env, napi_is_typedarray(env, v, &__is));
+    if(__is){
+        napi_typedarray_type __type;
+        size_t __length = 0;
+        void* __data = 0;
+        __node_check(env, napi_get_typedarray_info(env, v, &__type, &__length, &__data, 0, 0));
+        if(__type == napi_uint8_array || __type == napi_int8_array || __type == napi_uint8_clamped_array){
+            return std::string((const char*)__data, __length);
+        }
+    }
+    __node_check(env, napi_is_arraybuffer(env, v, &__is));
+    if(__is){
+        void* __data = 0;
+        size_t __length = 0;
+        __node_check(env, napi_get_arraybuffer_info(env, v, &__data, &__length));
+        return std::string((const char*)__data, __length);
+    }
+    throw __node_type_error("Cannot pass " + __node_describe(env, v) + " as a std::string");
+}
+
+template<>
+struct __node_wire<std::string> {
+    static napi_value to_js(napi_env env, const std::string& v) {
+        napi_value __ret;
+        __node_check(env, napi_create_string_utf8(env, v.data(), v.size(), &__ret));
+        return __ret;
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):value(__node_string(env, v)) {}
+        std::string& get() { return value; }
+        std::string value;
+    };
+};
+
+template<>
+struct __node_wire<const char*> {
+    static napi_value to_js(napi_env env, const char* v) {
+        napi_value __ret;
+        __node_check(env, napi_create_string_utf8(env, v ? v : "", NAPI_AUTO_LENGTH, &__ret));
+        return __ret;
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):value(__node_string(env, v)) {}
+        const char* get() { return value.c_str(); }
+        std::string value;
+    };
+};
+
+template<>
+struct __node_wire<char*> : public __node_wire<const char*> {};
+
+// enums: the enum_ value objects, plain numbers when the enum is not bound
+inline napi_value __node_enum_value(napi_env env, const std::type_info& type, int64_t v) {
+    std::map<std::type_index, __node_enum*>::const_iterator it = __node_reg().enum_by_type.find(type);
+    if(it != __node_reg().enum_by_type.end()){
+        __node_env_state& __state = __node_state(env);
+        std::map<int64_t, napi_ref>& __values = __state.enum_values[it->second];
+        std::map<int64_t, napi_ref>::const_iterator __v = __values.find(v);
+        if(__v != __values.end()){
+            napi_value __ret;
+            __node_check(env, napi_get_reference_value(env, __v->second, &__ret));
+            return __ret;
+        }
+    }
+    napi_value __ret;
+    __node_check(env, napi_create_double(env, (double)v, &__ret));
+    return __ret;
+}
+
+template<typename T>
+struct __node_wire<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+    static napi_value to_js(napi_env env, T v) {
+        return __node_enum_value(env, typeid(T), (int64_t)v);
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):value() {
+            if(__node_typeof(env, v) == napi_object){
+                v = __node_get(env, v, "value");
+            }
+            value = (T)__node_number<int64_t>(env, v);
+        }
+        T& get() { return value; }
+        T value;
+    };
+};
+
+template<typename T> struct __node_typed_array;
+template<> struct __node_typed_array<char> { static const napi_typedarray_type type = napi_int8_array; };
+template<> struct __node_typed_array<signed char> { static const napi_typedarray_type type = napi_int8_array; };
+template<> struct __node_typed_array<unsigned char> { static const napi_typedarray_type type = napi_uint8_array; };
+template<> struct __node_typed_array<int16_t> { static const napi_typedarray_type type = napi_int16_array; };
+template<> struct __node_typed_array<uint16_t> { static const napi_typedarray_type type = napi_uint16_array; };
+template<> struct __node_typed_array<int32_t> { static const napi_typedarray_type type = napi_int32_array; };
+template<> struct __node_typed_array<uint32_t> { static const napi_typedarray_type type = napi_uint32_array; };
+template<> struct __node_typed_array<int64_t> { static const napi_typedarray_type type = napi_bigint64_array; };
+template<> struct __node_typed_array<uint64_t> { static const napi_typedarray_type type = napi_biguint64_array; };
+template<> struct __node_typed_array<float> { static const napi_typedarray_type type = napi_float32_array; };
+template<> struct __node_typed_array<double> { static const napi_typedarray_type type = napi_float64_array; };
+
+inline void __node_no_finalize(napi_env, void*, void*) {
+}
+
+template<typename T>
+struct __node_wire<memory_view<T> > {
+    static napi_value to_js(napi_env env, const memory_view<T>& v) {
+        napi_value __buffer;
+        size_t __bytes = v.size * sizeof(T);
+        if(!v.data || !__bytes){
+            __node_check(env, napi_create_arraybuffer(env, 0, 0, &__buffer));
+        }else if(napi_create_external_arraybuffer(env, (void*)v.data, __bytes, &__node_no_finalize, 0, &__buffer) != napi_ok){
+            // runtimes without external buffers get a copy
+            void* __data = 0;
+            __node_check(env, napi_create_arraybuffer(env, __bytes, &__data, &__buffer));
+            std::memcpy(__data, v.data, __bytes);
+        }
+        napi_value __ret;
+        __node_check(env, napi_create_typedarray(env, __node_typed_array<T>::type, v.data ? v.size : 0, __buffer, 0, &__ret));
+        return __ret;
+    }
+};
+
+// shared pointers share ownership with the JS object, as embind smart_ptr
+template<typename T>
+struct __node_wire<boost::shared_ptr<T> > {
+    typedef typename std::remove_const<T>::type _type;
+
+    static napi_value to_js(napi_env env, const boost::shared_ptr<T>& p) {
+        if(!p){
+            return __node_null(env);
+        }
+        boost::shared_ptr<_type> __p = boost::const_pointer_cast<_type>(p);
+        return __node_new(env, __node_require_class(typeid(_type)), __p.get(), __p);
+    }
+    struct holder {
+        holder(napi_env env, napi_value v) {
+            napi_valuetype __type = __node_typeof(env, v);
+            if(__type != napi_null && __type != napi_undefined){
+                boost::shared_ptr<void> __owner;
+                _type* __ptr = (_type*)__node_cast(env, v, typeid(_type), &__owner);
+                value = boost::shared_ptr<T>(__owner, __ptr);
+            }
+        }
+        boost::shared_ptr<T>& get() { return value; }
+        boost::shared_ptr<T> value;
+    };
+};
+
+template<typename T>
+struct __node_wire<std::shared_ptr<T> > {
+    typedef typename std::remove_const<T>::type _type;
+
+    static napi_value to_js(napi_env env, const std::shared_ptr<T>& p) {
+        if(!p){
+            return __node_null(env);
+        }
+        std::shared_ptr<_type> __p = std::const_pointer_cast<_type>(p);
+        boost::shared_ptr<void> __owner(__p.get(), [__p](void*) mutable { __p.reset(); });
+        return __node_new(env, __node_require_class(typeid(_type)), __p.get(), __owner);
+    }
+    struct holder {
+        holder(napi_env env, napi_value v) {
+            napi_valuetype __type = __node_typeof(env, v);
+            if(__type != napi_null && __type != napi_undefined){
+                boost::shared_ptr<void> __owner;
+                _type* __ptr = (_type*)__node_cast(env, v, typeid(_type), &__owner);
+                value = std::shared_ptr<T>(__ptr, [__owner](T*) {});
+            }
+        }
+        std::shared_ptr<T>& get() { return value; }
+        std::shared_ptr<T> value;
+    };
+};
+
+// raw pointers are borrowed: the JS object does not keep them alive
+template<typename T>
+struct __node_wire<T*, typename std::enable_if<std::is_class<T>::value>::type> {
+    typedef typename std::remove_const<T>::type _type;
+
+    static napi_value to_js(napi_env env, T* p) {
+        if(!p){
+            return __node_null(env);
+        }
+        return __node_new(env, __node_require_class(typeid(_type)), (void*)const_cast<_type*>(p), boost::shared_ptr<void>());
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):value(0) {
+            napi_valuetype __type = __node_typeof(env, v);
+            if(__type != napi_null && __type != napi_undefined){
+                value = (T*)__node_cast(env, v, typeid(_type));
+            }
+        }
+        T*& get() { return value; }
+        T* value;
+    };
+};
+
+template<typename T>
+struct __node_is_vector : public std::false_type {};
+template<typename T, typename A>
+struct __node_is_vector<std::vector<T, A> > : public std::true_type {};
+
+template<typename T>
+void __node_fill_vector(napi_env env, napi_value v, T& out) {
+    uint32_t __n = __node_length(env, v);
+    out.reserve(__n);
+    for(uint32_t i = 0; i < __n; i++){
+        napi_value __e;
+        __node_check(env, napi_get_element(env, v, i, &__e));
+        out.push_back(__node_arg<const typename T::value_type&>(env, __e).get());
+    }
+}
+
+// class types with a conversion of their own above
+template<typename T> struct __node_special : public std::false_type {};
+template<typename T> struct __node_special<boost::shared_ptr<T> > : public std::true_type {};
+template<typename T> struct __node_special<std::shared_ptr<T> > : public std::true_type {};
+template<typename T> struct __node_special<memory_view<T> > : public std::true_type {};
+
+/*
+ * Bound classes (class_, register_vector, register_map) and value types
+ * (value_object, value_array). Class values are copied into a new JS
+ * object, as embind does for returns by value and reference.
+ */
+template<typename T>
+struct __node_wire<T, typename std::enable_if<std::is_class<T>::value && !__node_special<T>::value>::type> {
+    static napi_value to_js(napi_env env, const T& v) {
+        const __node_class* __cls = __node_require_class(typeid(T));
+        if(__cls->kind == __NODE_VALUE_OBJECT){
+            napi_value __ret;
+            __node_check(env, napi_create_object(env, &__ret));
+            for(size_t i = 0; i < __cls->fields.size(); i++){
+                __node_check(env, napi_set_named_property(env, __ret, __cls->fields[i]->name.c_str(), __cls->fields[i]->get(env, &v)));
+            }
+            return __ret;
+        }
+        if(__cls->kind == __NODE_VALUE_ARRAY){
+            napi_value __ret;
+            __node_check(env, napi_create_array_with_length(env, __cls->fields.size(), &__ret));
+            for(size_t i = 0; i < __cls->fields.size(); i++){
+                __node_check(env, napi_set_element(env, __ret, (uint32_t)i, __cls->fields[i]->get(env, &v)));
+            }
+            return __ret;
+        }
+        if(!__cls->copy){
+            throw std::runtime_error(__cls->name + " cannot be copied to JS");
+        }
+        __node_holder __copy = __cls->copy(&v);
+        return __node_new(env, __cls, __copy.ptr, __copy.owner);
+    }
+    struct holder {
+        holder(napi_env env, napi_value v):ptr(0) {
+            const __node_class* __cls = __node_find_class(typeid(T));
+            if(__cls && __cls->kind != __NODE_CLASS){
+                __node_holder __made = __cls->make();
+                for(size_t i = 0; i < __cls->fields.size(); i++){
+                    napi_value __f;
+                    if(__cls->kind == __NODE_VALUE_OBJECT){
+                        __f = __node_get(env, v, __cls->fields[i]->name.c_str());
+                    }else{
+                        __node_check(env, napi_get_element(env, v, (uint32_t)i, &__f));
+                    }
+                    __cls->fields[i]->set(env, __f, __made.ptr);
+                }
+                temp = boost::shared_ptr<T>(__made.owner, (T*)__made.ptr);
+                ptr = temp.get();
+                return;
+            }
+            if constexpr (__node_is_vector<T>::value){
+                // plain JS arrays are accepted where a registered vector is expected
+                if(__node_is_array(env, v)){
+                    temp = boost::make_shared<T>();
+                    __node_fill_vector(env, v, *temp);
+                    ptr = temp.get();
+                    return;
+                }
+            }
+            ptr = (T*)__node_cast(env, v, typeid(T));
+        }
+        T& get() { return *ptr; }
+        T* ptr;
+        boost::shared_ptr<T> temp;
+    };
+};
+
+/*
+ * Calling bound C++ functions
+ */
+template<typename R>
+struct __node_result {
+    template<typename F>
+    static napi_value call(napi_env env, F&& f) {
+        return __node_to_js(env, f());
+    }
+};
+
+template<>
+struct __node_result<void> {
+    template<typename F>
+    static napi_value call(napi_env env, F&& f) {
+        f();
+        return __node_undefined(env);
+    }
+};
+
+template<typename R, typename... A, typename F, size_t... I>
+napi_value __node_invoke(napi_env env, napi_value* argv, F&& f, std::index_sequence<I...>) {
+    (void)env;
+    (void)argv;
+    std::tuple<__node_arg<A>...> __args(__node_arg<A>(env, argv[I])...);
+    (void)__args;
+    return __node_result<R>::call(env, [&]() -> R { return f(std::get<I>(__args).get()...); });
+}
+
+// free function: all arguments from JS
+template<typename F>
+struct __node_function;
+
+template<typename R, typename... A>
+struct __node_function<R (*)(A...)> {
+    static const size_t arity = sizeof...(A);
+
+    static __node_invoker make(R (*f)(A...)) {
+        return [f](napi_env env, napi_value, napi_value* argv) -> napi_value {
+            return __node_invoke<R, A...>(env, argv, f, std::index_sequence_for<A...>());
+        };
+    }
+};
+
+// method of class T: a member function (possibly of a base of T), or a free
+// function taking the object first
+template<typename T, typename F>
+struct __node_method;
+
+template<typename T, typename R, typename C, typename... A>
+struct __node_method<T, R (C::*)(A...)> {
+    static const size_t arity = sizeof...(A);
+
+    static __node_invoker make(R (C::*f)(A...)) {
+        return [f](napi_env env, napi_value self, napi_value* argv) -> napi_value {
+            T& __obj = __node_arg<T&>(env, self).get();
+            return __node_invoke<R, A...>(env, argv, [&](A... a) -> R { return (__obj.*f)(std::forward<A>(a)...); }, std::index_sequence_for<A...>());
+        };
+    }
+};
+
+template<typename T, typename R, typename C, typename... A>
+struct __node_method<T, R (C::*)(A...) const> {
+    static const size_t arity = sizeof...(A);
+
+    static __node_invoker make(R (C::*f)(A...) const) {
+        return [f](napi_env env, napi_value self, napi_value* argv) -> napi_value {
+            const T& __obj = __node_arg<const T&>(env, self).get();
+            return __node_invoke<R, A...>(env, argv, [&](A... a) -> R { return (__obj.*f)(std::forward<A>(a)...); }, std::index_sequence_for<A...>());
+        };
+    }
+};
+
+template<typename T, typename R, typename S, typename... A>
+struct __node_method<T, R (*)(S, A...)> {
+    static const size_t arity = sizeof...(A);
+
+    static __node_invoker make(R (*f)(S, A...)) {
+        return [f](napi_env env, napi_value self, napi_value* argv) -> napi_value {
+            napi_value __all[sizeof...(A) + 1];
+            __all[0] = self;
+            for(size_t i = 0; i < sizeof...(A); i++){
+                __all[i + 1] = argv[i];
+            }
+            return __node_invoke<R, S, A...>(env, __all, f, std::index_sequence_for<S, A...>());
+        };
+    }
+};
+
+// constructors and factories
+template<typename T>
+__node_holder __node_own(T* p) {
+    boost::shared_ptr<T> __p(p);
+    return __node_holder{__p.get(), __p};
+}
+
+template<typename T>
+__node_holder __node_own(const boost::shared_ptr<T>& p) {
+    return __node_holder{p.get(), p};
+}
+
+template<typename T>
+__node_holder __node_own(const std::shared_ptr<T>& p) {
+    boost::shared_ptr<void> __owner(p.get(), [p](void*) mutable { p.reset(); });
+    return __node_holder{p.get(), __owner};
+}
+
+template<typename T, typename V>
+__node_holder __node_own(V&& v, typename std::enable_if<std::is_same<typename std::decay<V>::type, T>::value>::type* = 0) {
+    boost::shared_ptr<T> __p = boost::make_shared<T>(std::forward<V>(v));
+    return __node_holder{__p.get(), __p};
+}
+
+template<typename T, typename... A, size_t... I>
+__node_holder __node_construct_from(napi_env env, napi_value* argv, std::index_sequence<I...>) {
+    (void)env;
+    (void)argv;
+    std::tuple<__node_arg<A>...> __args(__node_arg<A>(env, argv[I])...);
+    (void)__args;
+    boost::shared_ptr<T> __p = boost::make_shared<T>(std::get<I>(__args).get()...);
+    return __node_holder{__p.get(), __p};
+}
+
+template<typename T, typename R, typename... A, size_t... I>
+__node_holder __node_construct_with(napi_env env, R (*factory)(A...), napi_value* argv, std::index_sequence<I...>) {
+    (void)env;
+    (void)argv;
+    std::tuple<__node_arg<A>...> __args(__node_arg<A>(env, argv[I])...);
+    (void)__args;
+    if constexpr (std::is_same<typename std::decay<R>::type, T>::value){
+        return __node_own<T>(factory(std::get<I>(__args).get()...));
+    }else{
+        return __node_own(factory(std::get<I>(__args).get()...));
+    }
+}
+
+template<typename T>
+__node_holder __node_copy(const void* p) {
+    boost::shared_ptr<T> __p = boost::make_shared<T>(*(const T*)p);
+    return __node_holder{__p.get(), __p};
+}
+
+template<typename T>
+__node_holder __node_make() {
+    boost::shared_ptr<T> __p = boost::make_shared<T>();
+    return __node_holder{__p.get(), __p};
+}
+
+template<typename T, typename B>
+void* __node_upcast(void* p) {
+    return static_cast<B*>((T*)p);
+}
+
+template<typename T>
+__node_class* __node_class_for(const char* name, __node_kind kind) {
+    __node_registry& __reg = __node_reg();
+    std::map<std::type_index, __node_class*>::iterator it = __reg.class_by_type.find(typeid(T));
+    if(it != __reg.class_by_type.end()){
+        return it->second;
+    }
+    __node_class* __cls = new __node_class(name, typeid(T), kind);
+    if constexpr (std::is_copy_constructible<T>::value){
+        __cls->copy = &__node_copy<T>;
+    }
+    if constexpr (std::is_default_constructible<T>::value){
+        __cls->make = &__node_make<T>;
+    }
+    __reg.classes.push_back(__cls);
+    __reg.class_by_type[typeid(T)] = __cls;
+    return __cls;
+}
+
+/*
+ * embind declarations
+ */
+struct allow_raw_pointers {};
+template<typename... A> struct allow_raw_pointer {};
+struct return_value_policy {
+    struct take_ownership {};
+    struct reference {};
+};
+
+enum class sharing_policy {
+    NONE = 0,
+    INTRUSIVE = 1,
+    BY_EMVAL = 2,
+};
+
+template<typename PointerType>
+struct smart_ptr_trait {};
+
+namespace internal {
+typedef napi_value EM_VAL;
+}
+
+template<typename Signature>
+Signature* select_overload(Signature* f) {
+    return f;
+}
+
+template<typename Signature, typename C>
+auto select_overload(Signature (C::*f)) -> decltype(f) {
+    return f;
+}
+
+template<typename L>
+auto optional_override(const L& l) -> decltype(+l) {
+    return +l;
+}
+
+struct __node_no_base {};
+
+template<typename B>
+struct base {
+    typedef B class_type;
+};
+
+template<typename T, typename B>
+void __node_set_base(__node_class*, B) {
+}
+
+template<typename T, typename B>
+void __node_set_base(__node_class* cls, base<B>) {
+    cls->base_type = &typeid(B);
+    cls->upcast = &__node_upcast<T, B>;
+}
+
+template<typename T, typename BaseSpecifier = __node_no_base>
+class class_ {
+public:
+    typedef T class_type;
+
+    explicit class_(const char* name):m_class(__node_class_for<T>(name, __NODE_CLASS)) {
+        __node_set_base<T>(m_class, BaseSpecifier());
+    }
+
+    template<typename... A, typename... Policies>
+    const class_& constructor(Policies...) const {
+        m_class->ctors[sizeof...(A)] = [](napi_env env, napi_value* argv) {
+            return __node_construct_from<T, A...>(env, argv, std::index_sequence_for<A...>());
+        };
+        return *this;
+    }
+
+    template<typename R, typename... A, typename... Policies>
+    const class_& constructor(R (*factory)(A...), Policies...) const {
+        m_class->ctors[sizeof...(A)] = [factory](napi_env env, napi_value* argv) {
+            return __node_construct_with<T>(env, factory, argv, std::index_sequence_for<A...>());
+        };
+        return *this;
+    }
+
+    template<typename SmartPtr>
+    const class_& smart_ptr(const char*) const {
+        return *this;
+    }
+
+    template<typename SmartPtr, typename... A, typename... Policies>
+    const class_& smart_ptr_constructor(const char*, SmartPtr (*factory)(A...), Policies...) const {
+        return constructor(factory);
+    }
+
+    template<typename F, typename... Policies>
+    const class_& function(const char* name, F f, Policies...) const {
+        __node_add_overload(m_class->methods, name, m_class->name + "." + name, true,
+            __node_method<T, F>::arity, __node_method<T, F>::make(f));
+        return *this;
+    }
+
+    template<typename R, typename... A, typename... Policies>
+    const class_& class_function(const char* name, R (*f)(A...), Policies...) const {
+        __node_add_overload(m_class->statics, name, m_class->name + "." + name, false,
+            __node_function<R (*)(A...)>::arity, __node_function<R (*)(A...)>::make(f));
+        return *this;
+    }
+
+    template<typename M, typename C, typename = typename std::enable_if<!std::is_function<M>::value>::type>
+    const class_& property(const char* name, M C::*field) const {
+        __node_property* __prop = new __node_property();
+        __prop->name = name;
+        __prop->get = [field](napi_env env, napi_value self) {
+            const T& __obj = __node_arg<const T&>(env, self).get();
+            return __node_to_js(env, __obj.*field);
+        };
+        if constexpr (!std::is_const<M>::value && !std::is_array<M>::value){
+            __prop->set = [field](napi_env env, napi_value self, napi_value v) {
+                T& __obj = __node_arg<T&>(env, self).get();
+                __obj.*field = __node_arg<const M&>(env, v).get();
+            };
+        }
+        m_class->props.push_back(__prop);
+        return *this;
+    }
+
+    template<typename G, typename = typename std::enable_if<!std::is_member_object_pointer<G>::value>::type>
+    const class_& property(const char* name, G getter) const {
+        __node_property* __prop = new __node_property();
+        __prop->name = name;
+        __node_invoker __get = __node_method<T, G>::make(getter);
+        __prop->get = [__get](napi_env env, napi_value self) {
+            return __get(env, self, 0);
+        };
+        m_class->props.push_back(__prop);
+        return *this;
+    }
+
+    template<typename G, typename S>
+    const class_& property(const char* name, G getter, S setter) const {
+        property(name, getter);
+        __node_invoker __set = __node_method<T, S>::make(setter);
+        m_class->props.back()->set = [__set](napi_env env, napi_value self, napi_value v) {
+            __set(env, self, &v);
+        };
+        return *this;
+    }
+
+private:
+    __node_class* m_class;
+};
+
+template<typename T>
+class value_object {
+public:
+    explicit value_object(const char* name):m_class(__node_class_for<T>(name, __NODE_VALUE_OBJECT)) {}
+
+    template<typename M, typename C>
+    value_object& field(const char* name, M C::*member) {
+        __node_field* __field = new __node_field();
+        __field->name = name;
+        __field->get = [member](napi_env env, const void* p) {
+            return __node_to_js(env, ((const T*)p)->*member);
+        };
+        __field->set = [member](napi_env env, napi_value v, void* p) {
+            ((T*)p)->*member = __node_arg<const M&>(env, v).get();
+        };
+        m_class->fields.push_back(__field);
+        return *this;
+    }
+
+private:
+    __node_class* m_class;
+};
+
+template<typename T>
+class value_array {
+public:
+    explicit value_array(const char* name):m_class(__node_class_for<T>(name, __NODE_VALUE_ARRAY)) {}
+
+    template<typename M, typename C>
+    value_array& element(M C::*member) {
+        __node_field* __field = new __node_field();
+        __field->get = [member](napi_env env, const void* p) {
+            return __node_to_js(env, ((const T*)p)->*member);
+        };
+        __field->set = [member](napi_env env, napi_value v, void* p) {
+            ((T*)p)->*member = __node_arg<const M&>(env, v).get();
+        };
+        m_class->fields.push_back(__field);
+        return *this;
+    }
+
+private:
+    __node_class* m_class;
+};
+
+template<typename E>
+class enum_ {
+public:
+    explicit enum_(const char* name):m_enum(0) {
+        __node_registry& __reg = __node_reg();
+        std::map<std::type_index, __node_enum*>::iterator it = __reg.enum_by_type.find(typeid(E));
+        if(it == __reg.enum_by_type.end()){
+            m_enum = new __node_enum(name, typeid(E));
+            __reg.enums.push_back(m_enum);
+            __reg.enum_by_type[typeid(E)] = m_enum;
+        }else{
+            m_enum = it->second;
+        }
+    }
+
+    const enum_& value(const char* name, E v) const {
+        m_enum->values.push_back(std::make_pair(std::string(name), (int64_t)v));
+        return *this;
+    }
+
+private:
+    __node_enum* m_enum;
+};
+
+template<typename R, typename... A, typename... Policies>
+void function(const char* name, R (*f)(A...), Policies...) {
+    __node_add_overload(__node_reg().functions, name, name, false,
+        __node_function<R (*)(A...)>::arity, __node_function<R (*)(A...)>::make(f));
+}
+
+template<typename V>
+void constant(const char* name, const V& v) {
+    V __v(v);
+    __node_reg().constants.push_back(std::make_pair(std::string(name),
+        std::function<napi_value(napi_env)>([__v](napi_env env) { return __node_to_js(env, __v); })));
+}
+
+// register_vector / register_map with embind's method set
+template<typename T>
+void __node_vector_push_back(std::vector<T>& v, const T& value) {
+    v.push_back(value);
+}
+
+template<typename T>
+void __node_vector_resize(std::vector<T>& v, size_t n, const T& value) {
+    v.resize(n, value);
+}
+
+template<typename T>
+size_t __node_vector_size(const std::vector<T>& v) {
+    return v.size();
+}
+
+template<typename T>
+val __node_vector_get(const std::vector<T>& v, size_t i) {
+    return i < v.size() ? val(v[i]) : val::undefined();
+}
+
+template<typename T>
+bool __node_vector_set(std::vector<T>& v, size_t i, const T& value) {
+    if(i >= v.size()){
+        return false;
+    }
+    v[i] = value;
+    return true;
+}
+
+template<typename T>
+class_<std::vector<T> > register_vector(const char* name) {
+    class_<std::vector<T> > __cls(name);
+    __cls.template constructor<>()
+        .function("push_back", &__node_vector_push_back<T>)
+        .function("resize", &__node_vector_resize<T>)
+        .function("size", &__node_vector_size<T>)
+        .function("get", &__node_vector_get<T>)
+        .function("set", &__node_vector_set<T>);
+    return __cls;
+}
+
+template<typename K, typename V>
+size_t __node_map_size(const std::map<K, V>& m) {
+    return m.size();
+}
+
+template<typename K, typename V>
+val __node_map_get(const std::map<K, V>& m, const K& k) {
+    typename std::map<K, V>::const_iterator it = m.find(k);
+    return it == m.end() ? val::undefined() : val(it->second);
+}
+
+template<typename K, typename V>
+void __node_map_set(std::map<K, V>& m, const K& k, const V& v) {
+    m[k] = v;
+}
+
+template<typename K, typename V>
+std::vector<K> __node_map_keys(const std::map<K, V>& m) {
+    std::vector<K> __keys;
+    __keys.reserve(m.size());
+    for(typename std::map<K, V>::const_iterator it = m.begin(); it != m.end(); ++it){
+        __keys.push_back(it->first);
+    }
+    return __keys;
+}
+
+template<typename K, typename V>
+class_<std::map<K, V> > register_map(const char* name) {
+    class_<std::map<K, V> > __cls(name);
+    __cls.template constructor<>()
+        .function("size", &__node_map_size<K, V>)
+        .function("get", &__node_map_get<K, V>)
+        .function("set", &__node_map_set<K, V>)
+        .function("keys", &__node_map_keys<K, V>);
+    return __cls;
+}
+
+template<typename T>
+std::vector<T> vecFromJSArray(const val& v) {
+    std::vector<T> __ret;
+    __node_fill_vector(__node_env(), v.handle(), __ret);
+    return __ret;
+}
+
+template<typename T, typename S>
+void __node_convert_numbers(const S* from, size_t n, std::vector<T>& out) {
+    out.resize(n);
+    for(size_t i = 0; i < n; i++){
+        out[i] = (T)from[i];
+    }
+}
+
+// typed arrays are read in place, anything else element by element
+template<typename T>
+std::vector<T> convertJSArrayToNumberVector(const val& v) {
+    napi_env __env = __node_env();
+    std::vector<T> __ret;
+    bool __typed = false;
+    __node_check(__env, napi_is_typedarray(__env, v.handle(), &__typed));
+    if(__typed){
+        napi_typedarray_type __type;
+        size_t __n = 0;
+        void* __data = 0;
+        __node_check(__env, napi_get_typedarray_info(__env, v.handle(), &__type, &__n, &__data, 0, 0));
+        switch(__type){
+        case napi_int8_array: __node_convert_numbers(((const int8_t*)__data), __n, __ret); return __ret;
+        case napi_uint8_array:
+        case napi_uint8_clamped_array: __node_convert_numbers(((const uint8_t*)__data), __n, __ret); return __ret;
+        case napi_int16_array: __node_convert_numbers(((const int16_t*)__data), __n, __ret); return __ret;
+        case napi_uint16_array: __node_convert_numbers(((const uint16_t*)__data), __n, __ret); return __ret;
+        case napi_int32_array: __node_convert_numbers(((const int32_t*)__data), __n, __ret); return __ret;
+        case napi_uint32_array: __node_convert_numbers(((const uint32_t*)__data), __n, __ret); return __ret;
+        case napi_float32_array: __node_convert_numbers(((const float*)__data), __n, __ret); return __ret;
+        case napi_float64_array: __node_convert_numbers(((const double*)__data), __n, __ret); return __ret;
+        case napi_bigint64_array: __node_convert_numbers(((const int64_t*)__data), __n, __ret); return __ret;
+        case napi_biguint64_array: __node_convert_numbers(((const uint64_t*)__data), __n, __ret); return __ret;
+        default: break;
+        }
+    }
+    size_t __n = v["length"].template as<size_t>();
+    __ret.reserve(__n);
+    for(size_t i = 0; i < __n; i++){
+        __ret.push_back(v[i].template as<T>());
+    }
+    return __ret;
+}
+
+struct __node_bindings {
+    explicit __node_bindings(void (*init)()) {
+        __node_reg().bindings.push_back(init);
+    }
+};
+
+/*
+ * Export: runs the EMSCRIPTEN_BINDINGS blocks once per process and creates
+ * the classes, enums, constants and functions once per env
+ */
+inline void __node_overload_error(napi_env env, const __node_overloads* o, size_t argc) {
+    std::string __expected;
+    for(std::map<size_t, __node_invoker>::const_iterator it = o->by_arity.begin(); it != o->by_arity.end(); ++it){
+        __expected += (__expected.empty() ? "" : ", ") + std::to_string(it->first);
+    }
+    (void)env;
+    throw __node_type_error("function " + o->label + " called with " + std::to_string(argc) +
+        " arguments, expected " + (o->by_arity.size() > 1 ? "one of (" + __expected + ")" : __expected));
+}
+
+struct __node_call {
+    napi_value self;
+    void* data;
+    size_t argc;
+    napi_value* argv;
+
+    __node_call(napi_env env, napi_callback_info info):self(0), data(0), argc(16), argv(m_buf) {
+        __node_check(env, napi_get_cb_info(env, info, &argc, m_buf, &self, &data));
+        if(argc > 16){
+            m_more.resize(argc);
+            __node_check(env, napi_get_cb_info(env, info, &argc, &m_more[0], &self, &data));
+            argv = &m_more[0];
+        }
+    }
+private:
+    napi_value m_buf[16];
+    std::vector<napi_value> m_more;
+};
+
+inline napi_value __node_dispatch(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        const __node_overloads* __o = (const __node_overloads*)__call.data;
+        if(__o->method){
+            __node_instance* __inst = __node_instance_of(env, __call.self);
+            if(__inst && !__inst->ptr){
+                throw std::runtime_error("cannot call emscripten binding method " + __o->label + " on deleted object");
+            }
+        }
+        std::map<size_t, __node_invoker>::const_iterator it = __o->by_arity.find(__call.argc);
+        if(it == __o->by_arity.end()){
+            __node_overload_error(env, __o, __call.argc);
+        }
+        return it->second(env, __call.self, __call.argv);
+    });
+}
+
+inline napi_value __node_construct(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        const __node_class* __cls = (const __node_class*)__call.data;
+        napi_value __target = 0;
+        __node_check(env, napi_get_new_target(env, info, &__target));
+        if(!__target){
+            throw __node_type_error("Use 'new' to construct " + __cls->name);
+        }
+        std::unique_ptr<__node_instance> __inst;
+        if(__call.argc == 1 && __node_typeof(env, __call.argv[0]) == napi_external){
+            // object handed out by __node_new()
+            void* __data = 0;
+            __node_check(env, napi_get_value_external(env, __call.argv[0], &__data));
+            __inst.reset(new __node_instance(*(const __node_instance*)__data));
+        }else{
+            std::map<size_t, __node_factory>::const_iterator it = __cls->ctors.find(__call.argc);
+            if(it == __cls->ctors.end()){
+                if(__cls->ctors.empty()){
+                    throw __node_type_error(__cls->name + " has no accessible constructor");
+                }
+                std::string __expected;
+                for(it = __cls->ctors.begin(); it != __cls->ctors.end(); ++it){
+                    __expected += (__expected.empty() ? "" : " or ") + std::to_string(it->first);
+                }
+                throw __node_type_error("Tried to invoke ctor of " + __cls->name + " with invalid number of parameters (" +
+                    std::to_string(__call.argc) + ") - expected (" + __expected + ") parameters instead!");
+            }
+            __node_holder __made = it->second(env, __call.argv);
+            __inst.reset(new __node_instance());
+            __inst->type = __cls;
+            __inst->ptr = __made.ptr;
+            __inst->owner = __made.owner;
+        }
+        __node_check(env, napi_type_tag_object(env, __call.self, __node_tag()));
+        __node_check(env, napi_wrap(env, __call.self, __inst.get(), &__node_finalize, 0, 0));
+        __inst.release();
+        return __call.self;
+    });
+}
+
+inline napi_value __node_get_property(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        const __node_property* __prop = (const __node_property*)__call.data;
+        return __prop->get(env, __call.self);
+    });
+}
+
+inline napi_value __node_set_property(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        const __node_property* __prop = (const __node_property*)__call.data;
+        __prop->set(env, __call.self, __call.argc ? __call.argv[0] : __node_undefined(env));
+        return __node_undefined(env);
+    });
+}
+
+inline __node_instance* __node_this(napi_env env, napi_value self) {
+    __node_instance* __inst = __node_instance_of(env, self);
+    if(!__inst){
+        throw __node_type_error("not an instance of a bound class");
+    }
+    return __inst;
+}
+
+// delete(): drops this handle's reference now instead of at garbage collection
+inline napi_value __node_delete(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        __node_instance* __inst = __node_this(env, __call.self);
+        if(!__inst->ptr){
+            throw std::runtime_error(__inst->type->name + " instance already deleted");
+        }
+        __inst->ptr = 0;
+        __inst->owner.reset();
+        return __node_undefined(env);
+    });
+}
+
+inline napi_value __node_clone(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        __node_instance* __inst = __node_this(env, __call.self);
+        if(!__inst->ptr){
+            throw std::runtime_error(__inst->type->name + " instance already deleted");
+        }
+        return __node_new(env, __inst->type, __inst->ptr, __inst->owner);
+    });
+}
+
+inline napi_value __node_is_deleted(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        return __node_to_js(env, __node_this(env, __call.self)->ptr == 0);
+    });
+}
+
+inline napi_value __node_is_alias_of(napi_env env, napi_callback_info info) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_call __call(env, info);
+        __node_instance* __other = __call.argc ? __node_instance_of(env, __call.argv[0]) : 0;
+        return __node_to_js(env, __other && __other->ptr && __other->ptr == __node_this(env, __call.self)->ptr);
+    });
+}
+
+inline void __node_set_prototype_of(napi_env env, napi_value obj, napi_value proto) {
+    napi_value __object = __node_get(env, __node_global(env), "Object");
+    napi_value __argv[2] = {obj, proto};
+    __node_check(env, napi_call_function(env, __object, __node_get(env, __object, "setPrototypeOf"), 2, __argv, 0));
+}
+
+inline napi_value __node_define_class(napi_env env, const __node_class* cls) {
+    __node_env_state& __state = __node_state(env);
+    std::map<const __node_class*, napi_ref>::const_iterator it = __state.ctors.find(cls);
+    if(it != __state.ctors.end()){
+        napi_value __ret;
+        __node_check(env, napi_get_reference_value(env, it->second, &__ret));
+        return __ret;
+    }
+    napi_value __base = cls->base ? __node_define_class(env, cls->base) : 0;
+    // instance members go on the prototype as plain properties: class
+    // template members would reject instances of derived classes
+    std::vector<napi_property_descriptor> __statics, __members;
+    napi_property_attributes __method = (napi_property_attributes)(napi_writable | napi_configurable);
+    for(size_t i = 0; i < cls->statics.size(); i++){
+        napi_property_descriptor __d = {cls->statics[i]->name.c_str(), 0, &__node_dispatch, 0, 0, 0, (napi_property_attributes)(__method | napi_static), cls->statics[i]};
+        __statics.push_back(__d);
+    }
+    for(size_t i = 0; i < cls->methods.size(); i++){
+        napi_property_descriptor __d = {cls->methods[i]->name.c_str(), 0, &__node_dispatch, 0, 0, 0, __method, cls->methods[i]};
+        __members.push_back(__d);
+    }
+    for(size_t i = 0; i < cls->props.size(); i++){
+        napi_property_descriptor __d = {cls->props[i]->name.c_str(), 0, 0, &__node_get_property,
+            cls->props[i]->set ? &__node_set_property : 0, 0, napi_configurable, cls->props[i]};
+        __members.push_back(__d);
+    }
+    napi_property_descriptor __builtins[] = {
+        {"delete", 0, &__node_delete, 0, 0, 0, __method, 0},
+        {"clone", 0, &__node_clone, 0, 0, 0, __method, 0},
+        {"isDeleted", 0, &__node_is_deleted, 0, 0, 0, __method, 0},
+        {"isAliasOf", 0, &__node_is_alias_of, 0, 0, 0, __method, 0}
+    };
+    __members.insert(__members.end(), __builtins, __builtins + 4);
+    napi_value __ctor;
+    __node_check(env, napi_define_class(env, cls->name.c_str(), cls->name.size(), &__node_construct,
+        (void*)cls, __statics.size(), __statics.empty() ? 0 : &__statics[0], &__ctor));
+    napi_value __proto = __node_get(env, __ctor, "prototype");
+    __node_check(env, napi_define_properties(env, __proto, __members.size(), &__members[0]));
+    if(__base){
+        __node_set_prototype_of(env, __proto, __node_get(env, __base, "prototype"));
+        __node_set_prototype_of(env, __ctor, __base);
+    }
+    napi_ref __ref;
+    __node_check(env, napi_create_reference(env, __ctor, 1, &__ref));
+    __state.ctors[cls] = __ref;
+    return __ctor;
+}
+
+inline void __node_run_bindings() {
+    static std::once_flag __once;
+    std::call_once(__once, []() {
+        __node_registry& __reg = __node_reg();
+        for(size_t i = 0; i < __reg.bindings.size(); i++){
+            __reg.bindings[i]();
+        }
+        for(size_t i = 0; i < __reg.classes.size(); i++){
+            if(__reg.classes[i]->base_type){
+                __reg.classes[i]->base = __node_find_class(*__reg.classes[i]->base_type);
+            }
+        }
+    });
+}
+
+inline napi_value __node_enum_type(napi_env env, napi_callback_info) {
+    napi_throw_type_error(env, 0, "enum types cannot be constructed");
+    return 0;
+}
+
+inline void __node_delete_state(napi_env env, void* data, void*) {
+    __node_env_state* __state = (__node_env_state*)data;
+    for(std::map<const __node_class*, napi_ref>::iterator it = __state->ctors.begin(); it != __state->ctors.end(); ++it){
+        napi_delete_reference(env, it->second);
+    }
+    for(std::map<const __node_enum*, std::map<int64_t, napi_ref> >::iterator it = __state->enum_values.begin(); it != __state->enum_values.end(); ++it){
+        for(std::map<int64_t, napi_ref>::iterator v = it->second.begin(); v != it->second.end(); ++v){
+            napi_delete_reference(env, v->second);
+        }
+    }
+    delete __state;
+}
+
+inline napi_value __node_export(napi_env env, napi_value exports) {
+    return __node_guard(env, [&]() -> napi_value {
+        __node_run_bindings();
+        __node_registry& __reg = __node_reg();
+        __node_check(env, napi_set_instance_data(env, new __node_env_state(), &__node_delete_state, 0));
+        __node_env_state& __state = __node_state(env);
+
+        for(size_t i = 0; i < __reg.constants.size(); i++){
+            __node_check(env, napi_set_named_property(env, exports, __reg.constants[i].first.c_str(), __reg.constants[i].second(env)));
+        }
+        // as embind: Type is a function, each value an instance of it with a
+        // read-only .value, also listed in Type.values
+        for(size_t i = 0; i < __reg.enums.size(); i++){
+            const __node_enum* __enum = __reg.enums[i];
+            napi_value __obj, __proto, __values;
+            __node_check(env, napi_create_function(env, __enum->name.c_str(), NAPI_AUTO_LENGTH, &__node_enum_type, 0, &__obj));
+            __proto = __node_get(env, __obj, "prototype");
+            __node_check(env, napi_create_object(env, &__values));
+            for(size_t j = 0; j < __enum->values.size(); j++){
+                napi_value __v, __n;
+                __node_check(env, napi_create_object(env, &__v));
+                __node_set_prototype_of(env, __v, __proto);
+                __node_check(env, napi_create_double(env, (double)__enum->values[j].second, &__n));
+                napi_property_descriptor __d = {"value", 0, 0, 0, 0, __n, napi_default, 0};
+                __node_check(env, napi_define_properties(env, __v, 1, &__d));
+                __node_check(env, napi_set_named_property(env, __obj, __enum->values[j].first.c_str(), __v));
+                __node_check(env, napi_set_property(env, __values, __n, __v));
+                napi_ref __ref;
+                __node_check(env, napi_create_reference(env, __v, 1, &__ref));
+                __state.enum_values[__enum][__enum->values[j].second] = __ref;
+            }
+            __node_check(env, napi_set_named_property(env, __obj, "values", __values));
+            __node_check(env, napi_set_named_property(env, exports, __enum->name.c_str(), __obj));
+        }
+        for(size_t i = 0; i < __reg.classes.size(); i++){
+            if(__reg.classes[i]->kind == __NODE_CLASS){
+                __node_check(env, napi_set_named_property(env, exports, __reg.classes[i]->name.c_str(), __node_define_class(env, __reg.classes[i])));
+            }
+        }
+        for(size_t i = 0; i < __reg.functions.size(); i++){
+            napi_value __fn;
+            __node_check(env, napi_create_function(env, __reg.functions[i]->name.c_str(), NAPI_AUTO_LENGTH, &__node_dispatch, __reg.functions[i], &__fn));
+            __node_check(env, napi_set_named_property(env, exports, __reg.functions[i]->name.c_str(), __fn));
+        }
+        return exports;
+    });
+}
+
+} // namespace emscripten
+
+#define EMSCRIPTEN_BINDINGS(name) \
+    static void __node_bindings_##name##_init(); \
+    static const ::emscripten::__node_bindings __node_bindings_##name(&__node_bindings_##name##_init); \
+    static void __node_bindings_##name##_init()
+
+#endif
@@ -0,0 +1,2 @@
+// emscripten/bind.h for the native addon build, see caitlyn_node_bind.hpp
+#include <caitlyn_node_bind.hpp>